@@ -1,6 +1,7 @@
 #ifndef GUARD_ARCH_GRAPH_CLUSTER_H
 #define GUARD_ARCH_GRAPH_CLUSTER_H
 
+#include <cstdint>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -82,9 +83,69 @@ private:
 
   TaskMapping repr_(TaskMapping const &mapping,
                     ReprOptions const *options,
-                    TMORs *orbits,
+                    TMORsBase *orbits,
                     internal::timeout::flag aborted) override;
 
+  // representatives are determined by the subsystems
+  void enable_repr_table_(unsigned num_tasks,
+                          std::string const &path,
+                          unsigned num_threads,
+                          std::uint64_t max_size,
+                          AutomorphismOptions const *options,
+                          internal::timeout::flag aborted) override
+  {
+    for (auto i = 0u; i < _subsystems.size(); ++i) {
+      _subsystems[i]->enable_repr_table(
+        num_tasks,
+        path.empty() ? path : path + "." + std::to_string(i),
+        num_threads,
+        max_size,
+        options,
+        aborted);
+    }
+  }
+
+  void disable_repr_table_() override
+  {
+    for (auto const &subsystem : _subsystems)
+      subsystem->disable_repr_table();
+  }
+
+  bool repr_table_enabled_() const override
+  {
+    for (auto const &subsystem : _subsystems) {
+      if (!subsystem->repr_table_enabled())
+        return false;
+    }
+
+    return !_subsystems.empty();
+  }
+
+  void enable_element_table_(unsigned num_threads,
+                             std::uint64_t max_order,
+                             AutomorphismOptions const *options,
+                             internal::timeout::flag aborted) override
+  {
+    for (auto const &subsystem : _subsystems)
+      subsystem->enable_element_table(num_threads, max_order, options, aborted);
+  }
+
+  void disable_element_table_() override
+  {
+    for (auto const &subsystem : _subsystems)
+      subsystem->disable_element_table();
+  }
+
+  bool element_table_enabled_() const override
+  {
+    for (auto const &subsystem : _subsystems) {
+      if (!subsystem->element_table_enabled())
+        return false;
+    }
+
+    return !_subsystems.empty();
+  }
+
   std::vector<std::shared_ptr<ArchGraphSystem>> _subsystems;
 };
 
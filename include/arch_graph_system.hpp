@@ -1,16 +1,28 @@
 #ifndef GUARD_ARCH_GRAPH_SYSTEM_H
 #define GUARD_ARCH_GRAPH_SYSTEM_H
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <tuple>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "bsgs.hpp"
+#include "element_table.hpp"
+#include "perm.hpp"
 #include "perm_group.hpp"
+#include "repr_cache.hpp"
+#include "repr_table.hpp"
 #include "string.hpp"
 #include "task_mapping.hpp"
 #include "task_mapping_orbit.hpp"
+#include "task_mapping_orbit_external.hpp"
+#include "task_mapping_orbit_generator.hpp"
 #include "timeout.hpp"
 
 namespace mpsym
@@ -24,6 +36,7 @@ struct ReprOptions
     ITERATE,
     LOCAL_SEARCH,
     ORBITS,
+    BACKTRACK,
     AUTO = ITERATE
   };
 
@@ -47,14 +60,36 @@ struct ReprOptions
   bool match = true;
   bool optimize_symmetric = true;
 
+  unsigned orbits_num_threads = 1u;
+
   unsigned local_search_append_generators = 0u;
   unsigned local_search_sa_iterations = 100u;
   double local_search_sa_T_init = 1.0;
 };
 
+// a representative as determined by ArchGraphSystem::repr_element, an
+// automorphism transforming the original mapping into it and a stabilizer
+// chain of the automorphisms whose base starts with the processors used by
+// the representative (in order of their first occurrence), see
+// ArchGraphSystem::repr_update
+struct IncrementalRepr
+{
+  TaskMapping representative;
+  internal::Perm element;
+  internal::BSGS chain;
+};
+
+// automorphisms and all state needed to determine representatives are
+// initialized lazily but exactly once (until reset), afterwards they are
+// never modified again so that repr can be called from multiple threads
 class ArchGraphSystem
 {
 public:
+  ArchGraphSystem() = default;
+
+  ArchGraphSystem(ArchGraphSystem const &other);
+  ArchGraphSystem &operator=(ArchGraphSystem const &other);
+
   virtual ~ArchGraphSystem() = default;
 
   static std::shared_ptr<ArchGraphSystem> from_lua(
@@ -85,12 +120,20 @@ public:
   { throw std::logic_error("not implemented"); }
 
   bool automorphisms_ready() const
-  { return _automorphisms_valid; }
+  { return _automorphisms_valid.load(std::memory_order_acquire); }
 
   void reset_automorphisms()
   {
+    std::lock_guard<std::mutex> lock(_automorphisms_mutex);
+
     _automorphisms_valid = false;
     _automorphisms_is_symmetric_valid = false;
+
+    if (_repr_cache)
+      _repr_cache->clear();
+
+    _repr_table.reset();
+    _element_table.reset();
   }
 
   virtual unsigned automorphisms_degree() const
@@ -106,9 +149,13 @@ public:
     internal::timeout::flag aborted = internal::timeout::unset())
   {
     if (!automorphisms_ready()) {
-      _automorphisms = automorphisms_(options, aborted);
-      _automorphism_generators = _automorphisms.generators().with_inverses();
-      _automorphisms_valid = true;
+      std::lock_guard<std::mutex> lock(_automorphisms_mutex);
+
+      if (!automorphisms_ready()) {
+        _automorphisms = automorphisms_(options, aborted);
+        _automorphism_generators = _automorphisms.generators().with_inverses();
+        _automorphisms_valid.store(true, std::memory_order_release);
+      }
     }
 
     return _automorphisms;
@@ -126,21 +173,149 @@ public:
   TMO automorphisms_orbit(
     TaskMapping const &mapping,
     AutomorphismOptions const *options = nullptr,
+    unsigned num_threads = 1u,
+    internal::timeout::flag aborted = internal::timeout::unset());
+
+  // like automorphisms_orbit but enumerated out of core, see ExternalTMO
+  ExternalTMO automorphisms_orbit_external(
+    TaskMapping const &mapping,
+    std::string const &directory,
+    std::size_t memory_limit = ExternalTMO::DEFAULT_MEMORY_LIMIT,
+    AutomorphismOptions const *options = nullptr,
+    internal::timeout::flag aborted = internal::timeout::unset());
+
+  // number of mappings in the orbit of mapping, determined via the
+  // orbit-stabilizer theorem without enumerating the orbit, tasks outside of
+  // [offset, offset + degree) are never permuted
+  internal::BSGS::order_type orbit_size(
+    TaskMapping const &mapping,
+    unsigned offset = 0u,
+    AutomorphismOptions const *options = nullptr,
+    internal::timeout::flag aborted = internal::timeout::unset());
+
+  // lazily enumerate the representative of every orbit of mappings of
+  // num_tasks tasks (only those starting with prefix and/or mapping no two
+  // tasks to the same processor if requested), see TMORGenerator
+  TMORGenerator orbit_reprs(
+    unsigned num_tasks,
+    bool injective = false,
+    TaskMapping const &prefix = TaskMapping(),
+    AutomorphismOptions const *options = nullptr,
+    internal::timeout::flag aborted = internal::timeout::unset());
+
+  // number of orbits of the automorphism group on the set of all mappings of
+  // num_tasks tasks (only those mapping no two tasks to the same processor if
+  // injective is true), determined via Burnside's lemma without enumerating
+  // any task mappings
+  internal::BSGS::order_type num_orbits(
+    unsigned num_tasks,
+    bool injective = false,
+    AutomorphismOptions const *options = nullptr,
+    internal::timeout::flag aborted = internal::timeout::unset());
+
+  // bijection between the representatives of all orbits of mappings of a
+  // fixed number of tasks and [0, num_orbits), ranks follow the lexicographical
+  // order of the representatives
+  internal::BSGS::order_type rank(
+    TaskMapping const &representative,
+    bool injective = false,
+    AutomorphismOptions const *options = nullptr,
+    internal::timeout::flag aborted = internal::timeout::unset());
+
+  TaskMapping unrank(
+    unsigned num_tasks,
+    internal::BSGS::order_type const &rank,
+    bool injective = false,
+    AutomorphismOptions const *options = nullptr,
     internal::timeout::flag aborted = internal::timeout::unset());
 
   void init_repr(
     AutomorphismOptions const *options = nullptr,
     internal::timeout::flag aborted = internal::timeout::unset())
   {
-    if (!repr_ready_())
-      init_repr_(options, aborted);
+    if (!repr_ready_()) {
+      std::lock_guard<std::mutex> lock(_repr_mutex);
+
+      if (!repr_ready_())
+        init_repr_(options, aborted);
+    }
   }
 
   bool repr_ready() const
   { return repr_ready_(); }
 
   void reset_repr()
-  { reset_repr_(); }
+  {
+    std::lock_guard<std::mutex> lock(_repr_mutex);
+
+    reset_repr_();
+
+    if (_repr_cache)
+      _repr_cache->clear();
+  }
+
+  // remember the representatives of up to capacity recently seen task
+  // mappings, this is only done for methods which are guaranteed to find
+  // the correct representative, must not be called concurrently with repr
+  void enable_repr_cache(std::size_t capacity)
+  { _repr_cache = std::make_shared<internal::ReprCache>(capacity); }
+
+  void disable_repr_cache()
+  { _repr_cache.reset(); }
+
+  unsigned long long repr_cache_hits() const
+  { return _repr_cache ? _repr_cache->hits() : 0u; }
+
+  unsigned long long repr_cache_misses() const
+  { return _repr_cache ? _repr_cache->misses() : 0u; }
+
+  // precompute the representatives of all mappings of num_tasks tasks (of
+  // which there may be at most max_size) so that determining them becomes a
+  // table lookup, if path is not empty the table is loaded from there if it
+  // has previously been saved for the same architecture and saved there
+  // otherwise, architectures determining representatives via their
+  // subsystems (clusters and uniform super graphs) instead build one table
+  // for each group acting on these subsystems (max_size then limits each of
+  // them and the i-th table is stored at path.i), must not be called
+  // concurrently with repr
+  void enable_repr_table(
+    unsigned num_tasks,
+    std::string const &path = "",
+    unsigned num_threads = 1u,
+    std::uint64_t max_size = internal::ReprTable::DEFAULT_MAX_SIZE,
+    AutomorphismOptions const *options = nullptr,
+    internal::timeout::flag aborted = internal::timeout::unset())
+  {
+    enable_repr_table_(
+      num_tasks, path, num_threads, max_size, options, aborted);
+  }
+
+  void disable_repr_table()
+  { disable_repr_table_(); }
+
+  bool repr_table_enabled() const
+  { return repr_table_enabled_(); }
+
+  // store all automorphisms (of which there may be at most max_order)
+  // explicitly so that the ITERATE method scans contiguous memory instead of
+  // multiplying out the automorphisms one by one and the LOCAL_SEARCH method
+  // draws its random automorphisms from the table, architectures determining
+  // representatives via their subsystems (clusters and uniform super graphs)
+  // instead store the groups acting on these subsystems (max_order then
+  // limits each of them), the group returned by automorphisms is unaffected,
+  // must not be called concurrently with repr
+  void enable_element_table(
+    unsigned num_threads = 1u,
+    std::uint64_t max_order = internal::ElementTable::DEFAULT_MAX_ORDER,
+    AutomorphismOptions const *options = nullptr,
+    internal::timeout::flag aborted = internal::timeout::unset())
+  { enable_element_table_(num_threads, max_order, options, aborted); }
+
+  void disable_element_table()
+  { disable_element_table_(); }
+
+  bool element_table_enabled() const
+  { return element_table_enabled_(); }
 
   TaskMapping repr(
     TaskMapping const &mapping,
@@ -150,25 +325,60 @@ public:
     if (!repr_ready_())
       init_repr();
 
-    return repr_(mapping, options, nullptr, aborted);
+    return repr_cached(mapping, options, nullptr, aborted);
   }
 
   std::tuple<TaskMapping, bool, unsigned> repr(
     TaskMapping const &mapping,
-    TMORs &orbits,
+    TMORsBase &orbits,
     ReprOptions const *options = nullptr,
     internal::timeout::flag aborted = internal::timeout::unset())
   {
     if (!repr_ready_())
       init_repr();
 
-    auto representative(repr_(mapping, options, &orbits, aborted));
+    auto representative(repr_cached(mapping, options, &orbits, aborted));
 
     auto ins(orbits.insert(representative));
 
     return std::make_tuple(representative, ins.first, ins.second);
   }
 
+  // determine the lexicographically minimal representative and an
+  // automorphism transforming mapping into it
+  IncrementalRepr repr_element(
+    TaskMapping const &mapping,
+    ReprOptions const *options = nullptr,
+    internal::timeout::flag aborted = internal::timeout::unset());
+
+  // given the result of repr_element (or repr_update) for mapping, determine
+  // the same for mapping with the task at position task moved to pe, the
+  // stabilizer chain is only changed on the levels after those of the
+  // processors used by the tasks before the moved one
+  IncrementalRepr repr_update(
+    TaskMapping const &mapping,
+    IncrementalRepr const &previous,
+    unsigned task,
+    unsigned pe,
+    ReprOptions const *options = nullptr,
+    internal::timeout::flag aborted = internal::timeout::unset());
+
+  // representatives are determined by up to num_threads worker threads
+  // (all available hardware threads if num_threads is zero), the output
+  // is in input order and does not depend on num_threads
+  std::vector<TaskMapping> repr_batch(
+    std::vector<TaskMapping> const &mappings,
+    ReprOptions const *options = nullptr,
+    unsigned num_threads = 1u,
+    internal::timeout::flag aborted = internal::timeout::unset());
+
+  std::vector<std::tuple<TaskMapping, bool, unsigned>> repr_batch(
+    std::vector<TaskMapping> const &mappings,
+    TMORsBase &orbits,
+    ReprOptions const *options = nullptr,
+    unsigned num_threads = 1u,
+    internal::timeout::flag aborted = internal::timeout::unset());
+
 private:
   virtual internal::BSGS::order_type num_automorphisms_(
     AutomorphismOptions const *options,
@@ -181,6 +391,18 @@ private:
 
   bool automorphisms_symmetric(ReprOptions const *options);
 
+  TaskMapping repr_cached(TaskMapping const &mapping,
+                          ReprOptions const *options,
+                          TMORsBase *orbits,
+                          internal::timeout::flag aborted);
+
+  std::vector<TaskMapping> repr_batch_(
+    std::vector<TaskMapping> const &mappings,
+    ReprOptions const *options,
+    TMORsBase *orbits,
+    unsigned num_threads,
+    internal::timeout::flag aborted);
+
   virtual void init_repr_(AutomorphismOptions const *,
                           internal::timeout::flag )
   {}
@@ -193,12 +415,36 @@ private:
 
   virtual TaskMapping repr_(TaskMapping const &mapping,
                             ReprOptions const *options,
-                            TMORs *orbits,
+                            TMORsBase *orbits,
                             internal::timeout::flag aborted);
 
+  virtual void enable_repr_table_(unsigned num_tasks,
+                                  std::string const &path,
+                                  unsigned num_threads,
+                                  std::uint64_t max_size,
+                                  AutomorphismOptions const *options,
+                                  internal::timeout::flag aborted);
+
+  virtual void disable_repr_table_()
+  { _repr_table.reset(); }
+
+  virtual bool repr_table_enabled_() const
+  { return static_cast<bool>(_repr_table); }
+
+  virtual void enable_element_table_(unsigned num_threads,
+                                     std::uint64_t max_order,
+                                     AutomorphismOptions const *options,
+                                     internal::timeout::flag aborted);
+
+  virtual void disable_element_table_()
+  { _element_table.reset(); }
+
+  virtual bool element_table_enabled_() const
+  { return static_cast<bool>(_element_table); }
+
   static bool is_repr(TaskMapping const &tasks,
                       ReprOptions const *options,
-                      TMORs *orbits)
+                      TMORsBase *orbits)
   {
     if (!options->match || !orbits)
       return false;
@@ -208,14 +454,29 @@ private:
 
   TaskMapping min_elem_iterate(TaskMapping const &tasks,
                                ReprOptions const *options,
-                               TMORs *orbits,
+                               TMORsBase *orbits,
                                internal::timeout::flag aborted) const;
 
   TaskMapping min_elem_orbits(TaskMapping const &tasks,
                               ReprOptions const *options,
-                              TMORs *orbits,
+                              TMORsBase *orbits,
                               internal::timeout::flag aborted) const;
 
+  TaskMapping min_elem_backtrack(TaskMapping const &tasks,
+                                 ReprOptions const *options,
+                                 internal::timeout::flag aborted) const;
+
+  internal::Perm min_elem_backtrack_element(
+    TaskMapping const &tasks,
+    unsigned offset,
+    unsigned minimal_prefix,
+    internal::BSGS &chain,
+    internal::timeout::flag aborted) const;
+
+  void align_chain(TaskMapping const &tasks,
+                   unsigned offset,
+                   internal::BSGS &chain) const;
+
   TaskMapping min_elem_local_search(TaskMapping const &tasks,
                                     ReprOptions const *options) const;
 
@@ -237,13 +498,20 @@ private:
   internal::PermGroup _automorphisms;
   internal::PermSet _automorphism_generators;
 
-  bool _automorphisms_valid = false;
+  std::atomic<bool> _automorphisms_valid{false};
 
   bool _automorphisms_is_symmetric;
-  bool _automorphisms_is_symmetric_valid = false;
+  std::atomic<bool> _automorphisms_is_symmetric_valid{false};
 
   unsigned _automorphisms_smp;
   unsigned _automorphisms_lmp;
+
+  mutable std::mutex _automorphisms_mutex;
+  std::mutex _repr_mutex;
+
+  std::shared_ptr<internal::ReprCache> _repr_cache;
+  std::shared_ptr<internal::ReprTable const> _repr_table;
+  std::shared_ptr<internal::ElementTable const> _element_table;
 };
 
 } // namespace mpsym
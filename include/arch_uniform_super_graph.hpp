@@ -1,6 +1,8 @@
 #ifndef GUARD_ARCH_UNIFORM_SUPER_GRAPH_H
 #define GUARD_ARCH_UNIFORM_SUPER_GRAPH_H
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -16,7 +18,7 @@ namespace mpsym
 {
 
 class TaskMapping;
-class TMORs;
+class TMORsBase;
 
 class ArchUniformSuperGraph : public ArchGraphSystem
 {
@@ -70,9 +72,32 @@ private:
 
   TaskMapping repr_(TaskMapping const &mapping_,
                     ReprOptions const *options,
-                    TMORs *orbits,
+                    TMORsBase *orbits,
                     internal::timeout::flag aborted) override;
 
+  void enable_repr_table_(unsigned num_tasks,
+                          std::string const &path,
+                          unsigned num_threads,
+                          std::uint64_t max_size,
+                          AutomorphismOptions const *options,
+                          internal::timeout::flag aborted) override;
+
+  void disable_repr_table_() override;
+
+  bool repr_table_enabled_() const override;
+
+  void enable_element_table_(unsigned num_threads,
+                             std::uint64_t max_order,
+                             AutomorphismOptions const *options,
+                             internal::timeout::flag aborted) override;
+
+  void disable_element_table_() override;
+
+  bool element_table_enabled_() const override;
+
+  std::vector<std::shared_ptr<internal::ArchGraphAutomorphisms>>
+  sigmas() const;
+
   std::shared_ptr<internal::ArchGraphAutomorphisms>
   wreath_product_action_super_graph(AutomorphismOptions const *options,
                                     internal::timeout::flag aborted) const;
@@ -90,7 +115,7 @@ private:
   std::shared_ptr<internal::ArchGraphAutomorphisms> _sigma_total;
   std::shared_ptr<internal::ArchGraphAutomorphisms> _sigma_super_graph;
   std::vector<std::shared_ptr<internal::ArchGraphAutomorphisms>> _sigmas_proto;
-  bool _sigmas_valid = false;
+  std::atomic<bool> _sigmas_valid{false};
 };
 
 } // namespace mpsym
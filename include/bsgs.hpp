@@ -2,6 +2,7 @@
 #define GUARD_BSGS_H
 
 #include <cassert>
+#include <cstddef>
 #include <memory>
 #include <ostream>
 #include <stdexcept>
@@ -21,8 +22,10 @@ namespace mpsym
 namespace internal
 {
 
+class HybridTransversalsBudget;
 class Orbit;
 class Perm;
+class SchreierGeneratorQueue;
 class SchreierStructure;
 
 class BSGSTransversalsBase
@@ -45,6 +48,13 @@ public:
   void clear()
   { _schreier_structures.clear(); }
 
+  // copies share the schreier structures themselves, this is safe because
+  // schreier sims only extends structures in place while the BSGS is being
+  // constructed (i.e. before it can have been copied), afterwards (e.g. during
+  // a base change) levels are only ever replaced by new structures, the state
+  // hybrid transversals modify when read is synchronized internally
+  virtual std::shared_ptr<BSGSTransversalsBase> clone() const = 0;
+
   virtual std::shared_ptr<SchreierStructure> make_schreier_structure(
     unsigned root, unsigned degree, PermSet const &generators) = 0;
 
@@ -58,12 +68,36 @@ class BSGSTransversals : public BSGSTransversalsBase
 public:
   virtual ~BSGSTransversals() = default;
 
+  std::shared_ptr<BSGSTransversalsBase> clone() const override
+  { return std::make_shared<BSGSTransversals<T>>(*this); }
+
 private:
   std::shared_ptr<SchreierStructure> make_schreier_structure(
     unsigned root, unsigned degree, PermSet const &generators) override
   { return std::make_shared<T>(degree, root, generators); }
 };
 
+// all levels draw from the same memory budget, copies share it as well
+class BSGSHybridTransversals : public BSGSTransversalsBase
+{
+public:
+  explicit BSGSHybridTransversals(std::size_t budget);
+
+  virtual ~BSGSHybridTransversals() = default;
+
+  std::shared_ptr<BSGSTransversalsBase> clone() const override
+  { return std::make_shared<BSGSHybridTransversals>(*this); }
+
+  std::shared_ptr<HybridTransversalsBudget> budget() const
+  { return _budget; }
+
+private:
+  std::shared_ptr<SchreierStructure> make_schreier_structure(
+    unsigned root, unsigned degree, PermSet const &generators) override;
+
+  std::shared_ptr<HybridTransversalsBudget> _budget;
+};
+
 struct BSGSOptions;
 
 class BSGS
@@ -99,8 +133,14 @@ public:
        PermSet const &strong_generators,
        BSGSOptions const *options = nullptr);
 
+  BSGS(BSGS const &other);
+  BSGS(BSGS &&other) = default;
+
+  BSGS &operator=(BSGS const &other);
+  BSGS &operator=(BSGS &&other) = default;
+
   unsigned degree() const { return _degree; }
-  order_type order() const;
+  order_type order() const { return _order; }
 
   bool is_symmetric() const { return _is_symmetric; }
 
@@ -114,12 +154,23 @@ public:
   PermSet strong_generators(unsigned i) const;
 
   Orbit orbit(unsigned i) const;
+  unsigned orbit_size(unsigned i) const { return _orbit_sizes[i]; }
   Perm transversal(unsigned i, unsigned o) const;
   PermSet transversals(unsigned i) const;
   PermSet stabilizers(unsigned i) const;
 
+  bool has_pcgs() const { return _has_pcgs; }
+  PermSet pcgs() const { return PermSet(_pcgs.begin(), _pcgs.end()); }
+  std::vector<unsigned> pcgs_relative_orders() const
+  { return _pcgs_relative_orders; }
+  std::vector<Perm> const &pcgs_powers(unsigned i) const
+  { return _pcgs_powers[i]; }
+  Perm pcgs_element(std::vector<unsigned> const &exponents) const;
+
   std::pair<Perm, unsigned> strip(Perm const &perm, unsigned offs = 0) const;
   bool strips_completely(Perm const &perm) const;
+  std::vector<bool> strips_completely(std::vector<Perm> const &perms,
+                                      unsigned num_threads = 1u) const;
 
 private:
   // transversal initialization
@@ -142,6 +193,13 @@ private:
                      BSGSOptions const *options,
                      timeout::flag aborted);
 
+  void schreier_sims(std::vector<PermSet> &strong_generators,
+                     std::vector<Orbit> &fundamental_orbits,
+                     std::vector<SchreierGeneratorQueue> &schreier_generator_queues,
+                     unsigned i,
+                     BSGSOptions const *options,
+                     timeout::flag aborted);
+
   void schreier_sims_random(PermSet const &generators,
                             BSGSOptions const *options,
                             timeout::flag aborted);
@@ -163,6 +221,21 @@ private:
 
   void schreier_sims_finish();
 
+  // schreier sims checkpointing
+  void schreier_sims_checkpoint(
+    std::string const &file,
+    std::vector<PermSet> const &strong_generators,
+    std::vector<SchreierGeneratorQueue> const &schreier_generator_queues,
+    unsigned i) const;
+
+  bool schreier_sims_resume(
+    std::string const &file,
+    PermSet const &generators,
+    std::vector<PermSet> &strong_generators,
+    std::vector<Orbit> &fundamental_orbits,
+    std::vector<SchreierGeneratorQueue> &schreier_generator_queues,
+    unsigned &i);
+
   // solvable BSGS initialization
   void solve(PermSet const &generators);
 
@@ -172,6 +245,8 @@ private:
 
   void solve_adjoin_normalizing_generator(Perm const &gen);
 
+  void solve_finish();
+
   // generator reduction
   void reduce_gens();
 
@@ -186,6 +261,11 @@ private:
   unsigned insert_redundant_base_point(unsigned bp, unsigned i_min);
   void conjugate(Perm const &conj);
 
+  // invariants
+  void update_order();
+  void update_orbit_size(unsigned i);
+  void update_strong_generator_indices();
+
   // convenience methods
   void extend_base(unsigned bp);
   void extend_base(unsigned bp, unsigned i);
@@ -197,18 +277,26 @@ private:
   {
     _transversals->reserve_schreier_structure(
       i, base_point(i), _degree);
+
+    if (i >= _orbit_sizes.size())
+      _orbit_sizes.resize(i + 1u, 1u);
   }
 
   void update_schreier_structure(unsigned i, PermSet const &generators)
   {
     _transversals->update_schreier_structure(
       i, base_point(i), _degree, generators);
+
+    update_orbit_size(i);
   }
 
   void insert_schreier_structure(unsigned i, PermSet const &generators)
   {
     _transversals->insert_schreier_structure(
       i, base_point(i), _degree, generators);
+
+    _orbit_sizes.insert(_orbit_sizes.begin() + i, 1u);
+    update_orbit_size(i);
   }
 
   unsigned _degree;
@@ -217,6 +305,21 @@ private:
   std::shared_ptr<BSGSTransversalsBase> _transversals;
   PermSet _strong_generators;
 
+  // per level strong generator indices and fundamental orbit sizes
+  std::vector<std::vector<unsigned>> _strong_generator_indices;
+  std::vector<unsigned> _orbit_sizes;
+  order_type _order = 1;
+
+  // sizes of the strong generator sets successively added to each level
+  // during schreier sims, needed to deterministically replay checkpoints
+  std::vector<std::vector<unsigned>> _schreier_sims_updates;
+
+  // polycyclic generating sequence (only available for solvable groups)
+  bool _has_pcgs = false;
+  std::vector<Perm> _pcgs;
+  std::vector<unsigned> _pcgs_relative_orders;
+  std::vector<std::vector<Perm>> _pcgs_powers;
+
   bool _is_symmetric = false;
   bool _is_alternating = false;
 };
@@ -235,7 +338,8 @@ struct BSGSOptions
   enum class Transversals {
     EXPLICIT,
     SCHREIER_TREES,
-    SHALLOW_SCHREIER_TREES
+    SHALLOW_SCHREIER_TREES,
+    HYBRID
   };
 
   static BSGSOptions fill_defaults(BSGSOptions const *options)
@@ -247,6 +351,10 @@ struct BSGSOptions
   Construction construction = Construction::AUTO;
   Transversals transversals = Transversals::EXPLICIT;
 
+  // memory (in bytes) available to explicit transversals and cached coset
+  // representatives if transversals == HYBRID, shared by all levels
+  std::size_t hybrid_transversals_budget = 64u << 20;
+
   bool check_sym = true;
   bool reduce_gens = true;
 
@@ -255,6 +363,10 @@ struct BSGSOptions
   BSGS::order_type schreier_sims_random_known_order = 0;
   int schreier_sims_random_retries = -1;
   unsigned schreier_sims_random_w = 100u;
+
+  std::string schreier_sims_checkpoint_file;
+  double schreier_sims_checkpoint_interval = 0.0;
+  bool schreier_sims_checkpoint_resume = false;
 };
 
 } // namespace internal
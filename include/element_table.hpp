@@ -0,0 +1,142 @@
+#ifndef GUARD_ELEMENT_TABLE_H
+#define GUARD_ELEMENT_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "perm.hpp"
+#include "perm_group.hpp"
+#include "task_mapping.hpp"
+#include "timeout.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+// all elements of a (small) permutation group stored explicitly as one
+// contiguous array of images, using one byte per image for degrees up to
+// 256 and two bytes otherwise, the elements are sorted lexicographically by
+// their images so that the identity comes first and membership can be decided
+// by binary search, min_elem scans eight elements at once using AVX2 gathers
+// if the processor supports them
+class ElementTable
+{
+public:
+  static constexpr std::uint64_t DEFAULT_MAX_ORDER = 1000000u;
+
+  explicit ElementTable(PermGroup const &group,
+                        unsigned num_threads = 1u,
+                        std::uint64_t max_order = DEFAULT_MAX_ORDER,
+                        timeout::flag aborted = timeout::unset());
+
+  unsigned degree() const
+  { return _degree; }
+
+  std::size_t size() const
+  { return _size; }
+
+  Perm element(std::size_t i) const;
+
+  bool contains(Perm const &perm) const;
+
+  template<typename ENGINE>
+  Perm random_element(ENGINE &engine) const
+  {
+    std::uniform_int_distribution<std::size_t> d(0u, _size - 1u);
+    return element(d(engine));
+  }
+
+  // whether min_elem uses vector instructions (the default if available)
+  static bool simd_available();
+
+  bool simd() const
+  { return _simd; }
+
+  void set_simd(bool simd)
+  { _simd = simd && simd_available(); }
+
+  TaskMapping permuted(std::size_t i,
+                       TaskMapping const &tasks,
+                       unsigned offset) const;
+
+  // lexicographically smallest image of tasks under all elements, tasks
+  // outside of [offset, offset + degree) are left unchanged, visit is called
+  // for every new minimum and can stop the scan by returning true
+  template<typename FUNC>
+  TaskMapping min_elem(TaskMapping const &tasks,
+                       unsigned offset,
+                       FUNC &&visit,
+                       timeout::flag aborted = timeout::unset()) const
+  {
+    TaskMapping representative(tasks);
+
+    if (visit(representative))
+      return representative;
+
+    // the identity is the first element and can be skipped
+    for (std::size_t i = 1u;; ++i) {
+      i = find_smaller(tasks, offset, representative, i, aborted);
+      if (i == _size)
+        break;
+
+      representative = permuted(i, tasks, offset);
+
+      if (visit(representative))
+        break;
+    }
+
+    return representative;
+  }
+
+private:
+  template<typename T>
+  T *row(std::size_t i)
+  { return reinterpret_cast<T *>(_elements.data()) + i * _degree; }
+
+  template<typename T>
+  T const *row(std::size_t i) const
+  { return reinterpret_cast<T const *>(_elements.data()) + i * _degree; }
+
+  template<typename T>
+  void build(PermGroup const &group,
+             unsigned num_threads,
+             timeout::flag aborted);
+
+  template<typename T>
+  void sort();
+
+  template<typename T>
+  bool contains_(Perm const &perm) const;
+
+  // index of the first element from begin on under which the image of tasks
+  // is smaller than representative (or size() if there is none)
+  std::size_t find_smaller(TaskMapping const &tasks,
+                           unsigned offset,
+                           TaskMapping const &representative,
+                           std::size_t begin,
+                           timeout::flag aborted) const;
+
+  template<typename T>
+  std::size_t find_smaller_scalar(TaskMapping const &tasks,
+                                  unsigned offset,
+                                  TaskMapping const &representative,
+                                  std::size_t begin,
+                                  std::size_t end) const;
+
+  unsigned _degree;
+  unsigned _width;
+  std::size_t _size;
+  bool _simd;
+
+  std::vector<unsigned char> _elements;
+};
+
+} // namespace internal
+
+} // namespace mpsym
+
+#endif // GUARD_ELEMENT_TABLE_H
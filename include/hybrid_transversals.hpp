@@ -0,0 +1,133 @@
+#ifndef GUARD_HYBRID_TRANSVERSALS_H
+#define GUARD_HYBRID_TRANSVERSALS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "perm.hpp"
+#include "perm_set.hpp"
+#include "schreier_structure.hpp"
+#include "schreier_tree.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+// memory budget shared by all levels of a BSGS, explicit transversal tables
+// take precedence over cached coset representatives which are evicted in
+// least recently used order
+class HybridTransversalsBudget
+{
+public:
+  explicit HybridTransversalsBudget(std::size_t budget)
+  : _budget(budget)
+  {}
+
+  std::size_t budget() const
+  { return _budget; }
+
+  std::size_t bytes_used() const;
+
+  std::uint64_t make_id()
+  { return _next_id++; }
+
+  static std::size_t perm_bytes(unsigned degree)
+  { return sizeof(Perm) + degree * sizeof(unsigned); }
+
+  bool reserve(std::size_t bytes);
+  void release(std::size_t bytes);
+
+  bool cache_lookup(std::uint64_t id, unsigned origin, Perm &perm);
+  void cache_insert(std::uint64_t id, unsigned origin, Perm const &perm);
+
+private:
+  using key_type = std::pair<std::uint64_t, unsigned>;
+
+  struct KeyHash
+  {
+    std::size_t operator()(key_type const &key) const
+    { return std::hash<std::uint64_t>()(key.first * 0x9e3779b97f4a7c15ull ^ key.second); }
+  };
+
+  using lru_type = std::list<std::pair<key_type, Perm>>;
+
+  void cache_evict(std::size_t bytes);
+
+  std::size_t _budget;
+  std::size_t _reserved = 0u;
+  std::size_t _cached = 0u;
+  std::atomic<std::uint64_t> _next_id{0u};
+
+  mutable std::mutex _mutex;
+  lru_type _lru;
+  std::unordered_map<key_type, lru_type::iterator, KeyHash> _lru_index;
+};
+
+struct HybridTransversals : public SchreierStructure
+{
+  HybridTransversals(unsigned degree,
+                     unsigned root,
+                     PermSet const &labels,
+                     std::shared_ptr<HybridTransversalsBudget> budget)
+  : _degree(degree),
+    _tree(degree, root, labels),
+    _budget(budget),
+    _id(budget->make_id())
+  {}
+
+  virtual ~HybridTransversals()
+  { drop_explicit(); }
+
+  void add_label(Perm const &label) override;
+
+  void create_edge(unsigned origin,
+                   unsigned destination,
+                   unsigned label) override;
+
+  unsigned root() const override;
+  std::vector<unsigned> nodes() const override;
+  PermSet labels() const override;
+
+  bool contains(unsigned node) const override;
+  bool incoming(unsigned node, Perm const &edge) const override;
+  Perm transversal(unsigned origin) const override;
+
+  bool is_explicit() const
+  { return _explicit.load(std::memory_order_acquire); }
+
+private:
+  void dump(std::ostream &os) const override;
+
+  bool make_explicit(unsigned accesses) const;
+  void drop_explicit();
+
+  unsigned _degree;
+  SchreierTree _tree;
+  unsigned _orbit_size = 1u;
+
+  std::shared_ptr<HybridTransversalsBudget> _budget;
+  std::uint64_t _id;
+
+  mutable std::mutex _explicit_mutex;
+  mutable std::atomic<bool> _explicit{false};
+  mutable std::atomic<unsigned> _accesses{0u};
+  mutable std::atomic<unsigned> _explicit_retry{0u};
+  mutable std::vector<Perm> _explicit_table;
+  mutable std::size_t _explicit_bytes = 0u;
+};
+
+} // namespace internal
+
+} // namespace mpsym
+
+#endif // GUARD_HYBRID_TRANSVERSALS_H
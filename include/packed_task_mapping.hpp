@@ -0,0 +1,203 @@
+#ifndef GUARD_PACKED_TASK_MAPPING_H
+#define GUARD_PACKED_TASK_MAPPING_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "task_mapping.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+// compact representation of a task mapping used as key in hash based
+// containers, every task occupies the number of bits needed to represent the
+// largest task in the mapping, mappings of up to 128 bits are stored inline
+// (e.g. 16 tasks on up to 256 processors) and longer ones in a single heap
+// allocation which takes the place of the inline words, so that the whole
+// object occupies 24 bytes
+class PackedTaskMapping
+{
+  static constexpr unsigned WORD_BITS = 64u;
+  static constexpr unsigned INLINE_WORDS = 2u;
+  static constexpr unsigned NUM_WORDS_BITS = 26u;
+
+public:
+  PackedTaskMapping()
+  : _size(0u),
+    _bits(1u),
+    _num_words(0u)
+  { _words.inline_words[0] = _words.inline_words[1] = 0u; }
+
+  explicit PackedTaskMapping(TaskMapping const &mapping)
+  : _size(static_cast<std::uint32_t>(mapping.size()))
+  {
+    unsigned max = 0u;
+    for (unsigned task : mapping)
+      max = std::max(max, task);
+
+    unsigned bits = 1u;
+    while (bits < 32u && (max >> bits) != 0u)
+      ++bits;
+
+    unsigned per_word = WORD_BITS / bits;
+    unsigned num_words = (_size + per_word - 1u) / per_word;
+
+    assert(num_words < 1u << NUM_WORDS_BITS);
+
+    _bits = bits;
+    _num_words = num_words;
+
+    if (overflows())
+      _words.overflow = new std::uint64_t[num_words]();
+    else
+      _words.inline_words[0] = _words.inline_words[1] = 0u;
+
+    for (unsigned i = 0u; i < _size; ++i) {
+      word(i / per_word) |=
+        static_cast<std::uint64_t>(mapping[i]) << ((i % per_word) * bits);
+    }
+  }
+
+  PackedTaskMapping(PackedTaskMapping const &other)
+  : _size(other._size),
+    _bits(other._bits),
+    _num_words(other._num_words),
+    _words(other._words)
+  {
+    if (overflows()) {
+      _words.overflow = new std::uint64_t[_num_words];
+      std::copy(other._words.overflow,
+                other._words.overflow + _num_words,
+                _words.overflow);
+    }
+  }
+
+  // noexcept so that containers move rather than copy on reallocation
+  PackedTaskMapping(PackedTaskMapping &&other) noexcept
+  : PackedTaskMapping()
+  { swap(other); }
+
+  PackedTaskMapping &operator=(PackedTaskMapping other)
+  {
+    swap(other);
+    return *this;
+  }
+
+  ~PackedTaskMapping()
+  {
+    if (overflows())
+      delete[] _words.overflow;
+  }
+
+  void swap(PackedTaskMapping &other) noexcept
+  {
+    std::swap(_size, other._size);
+
+    unsigned bits = _bits;
+    _bits = other._bits;
+    other._bits = bits;
+
+    unsigned num_words = _num_words;
+    _num_words = other._num_words;
+    other._num_words = num_words;
+
+    std::swap(_words, other._words);
+  }
+
+  TaskMapping unpack() const
+  {
+    std::vector<unsigned> mapping(_size);
+
+    unsigned per_word = WORD_BITS / _bits;
+    std::uint64_t mask = (static_cast<std::uint64_t>(1u) << _bits) - 1u;
+
+    for (unsigned i = 0u; i < _size; ++i) {
+      mapping[i] = static_cast<unsigned>(
+        (word(i / per_word) >> ((i % per_word) * _bits)) & mask);
+    }
+
+    return TaskMapping(mapping);
+  }
+
+  unsigned size() const
+  { return _size; }
+
+  bool operator==(PackedTaskMapping const &rhs) const
+  {
+    if (_size != rhs._size || _bits != rhs._bits)
+      return false;
+
+    for (unsigned i = 0u; i < _num_words; ++i) {
+      if (word(i) != rhs.word(i))
+        return false;
+    }
+
+    return true;
+  }
+
+  bool operator!=(PackedTaskMapping const &rhs) const
+  { return !(*this == rhs); }
+
+  std::size_t hash() const
+  {
+    std::uint64_t h = (static_cast<std::uint64_t>(_size) << 8) | _bits;
+
+    for (unsigned i = 0u; i < _num_words; ++i) {
+      h ^= word(i) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+      h *= 0xbf58476d1ce4e5b9ull;
+      h ^= h >> 31;
+    }
+
+    return static_cast<std::size_t>(h);
+  }
+
+private:
+  bool overflows() const
+  { return _num_words > INLINE_WORDS; }
+
+  std::uint64_t &word(unsigned i)
+  { return overflows() ? _words.overflow[i] : _words.inline_words[i]; }
+
+  std::uint64_t word(unsigned i) const
+  { return overflows() ? _words.overflow[i] : _words.inline_words[i]; }
+
+  union Words
+  {
+    std::uint64_t inline_words[INLINE_WORDS];
+    std::uint64_t *overflow;
+  };
+
+  std::uint32_t _size;
+  std::uint32_t _bits : 32u - NUM_WORDS_BITS;
+  std::uint32_t _num_words : NUM_WORDS_BITS;
+  Words _words;
+};
+
+inline void swap(PackedTaskMapping &lhs, PackedTaskMapping &rhs) noexcept
+{ lhs.swap(rhs); }
+
+} // namespace internal
+
+} // namespace mpsym
+
+namespace std
+{
+
+template<>
+struct hash<mpsym::internal::PackedTaskMapping>
+{
+  std::size_t operator()(mpsym::internal::PackedTaskMapping const &mapping) const
+  { return mapping.hash(); }
+};
+
+} // namespace std
+
+#endif // GUARD_PACKED_TASK_MAPPING_H
@@ -0,0 +1,92 @@
+#ifndef GUARD_PARALLEL_H
+#define GUARD_PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace mpsym
+{
+
+namespace util
+{
+
+inline unsigned hardware_threads()
+{ return std::max(1u, std::thread::hardware_concurrency()); }
+
+// split [0, n) into (at most) num_threads contiguous chunks and call
+// func(begin, end, thread) for each of them, exceptions are propagated
+template<typename FUNC>
+void parallel_for(std::size_t n, unsigned num_threads, FUNC &&func)
+{
+  if (n == 0u)
+    return;
+
+  if (num_threads == 0u)
+    num_threads = hardware_threads();
+
+  num_threads = static_cast<unsigned>(
+    std::min(static_cast<std::size_t>(num_threads), n));
+
+  if (num_threads == 1u) {
+    func(static_cast<std::size_t>(0u), n, 0u);
+    return;
+  }
+
+  std::size_t chunk = n / num_threads;
+  std::size_t rest = n % num_threads;
+
+  std::vector<std::thread> threads;
+  std::vector<std::exception_ptr> exceptions(num_threads);
+
+  auto run = [&](std::size_t begin, std::size_t end, unsigned t)
+  {
+    try {
+      func(begin, end, t);
+    } catch (...) {
+      exceptions[t] = std::current_exception();
+    }
+  };
+
+  auto join = [&]
+  {
+    for (auto &thread : threads)
+      thread.join();
+  };
+
+  threads.reserve(num_threads - 1u);
+
+  std::size_t begin = 0u;
+  for (unsigned t = 0u; t < num_threads; ++t) {
+    std::size_t end = begin + chunk + (t < rest ? 1u : 0u);
+
+    if (t == num_threads - 1u) {
+      run(begin, end, t);
+    } else {
+      // joinable threads must not be destroyed if spawning fails
+      try {
+        threads.emplace_back(run, begin, end, t);
+      } catch (...) {
+        join();
+        throw;
+      }
+    }
+
+    begin = end;
+  }
+
+  join();
+
+  for (auto const &e : exceptions) {
+    if (e)
+      std::rethrow_exception(e);
+  }
+}
+
+} // namespace util
+
+} // namespace mpsym
+
+#endif // GUARD_PARALLEL_H
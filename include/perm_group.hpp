@@ -164,15 +164,29 @@ public:
   bool is_shifted_symmetric() const;
   bool is_transitive() const;
 
+  // element i is the number of elements fixing exactly i points, determined
+  // without enumerating elements for direct and wreath products of symmetric
+  // groups, throws std::runtime_error for large groups not built from these
+  std::vector<BSGS::order_type> fixed_points_distribution(
+    timeout::flag aborted = timeout::unset()) const;
+
   bool contains_element(Perm const &perm) const;
+  std::vector<bool> contains_elements(std::vector<Perm> const &perms,
+                                      unsigned num_threads = 1u) const;
   Perm random_element() const;
 
+  bool has_pcgs() const { return _bsgs.has_pcgs(); }
+  PermSet pcgs() const { return _bsgs.pcgs(); }
+  std::vector<unsigned> pcgs_relative_orders() const
+  { return _bsgs.pcgs_relative_orders(); }
+  Perm pcgs_element(std::vector<unsigned> const &exponents) const
+  { return _bsgs.pcgs_element(exponents); }
+
   std::vector<PermGroup> disjoint_decomposition(
     bool complete = true, bool disjoint_orbit_optimization = false) const;
 
   std::vector<PermGroup> wreath_decomposition() const;
 
-private:
   static boost::multiprecision::cpp_int symmetric_order(unsigned deg)
   {
     boost::multiprecision::cpp_int ret(1);
@@ -182,6 +196,7 @@ private:
     return ret;
   }
 
+private:
   // complete disjoint decomposition
   bool disjoint_decomp_orbits_dependent(
     Orbit const &orbit1,
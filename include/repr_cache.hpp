@@ -0,0 +1,74 @@
+#ifndef GUARD_REPR_CACHE_H
+#define GUARD_REPR_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "task_mapping.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+// bounded least recently used cache of orbit representatives, the
+// task offset is part of the key since it changes the representative
+class ReprCache
+{
+public:
+  explicit ReprCache(std::size_t capacity)
+  : _capacity(capacity)
+  {}
+
+  std::size_t capacity() const
+  { return _capacity; }
+
+  std::size_t size() const;
+
+  unsigned long long hits() const
+  { return _hits.load(); }
+
+  unsigned long long misses() const
+  { return _misses.load(); }
+
+  bool lookup(TaskMapping const &mapping,
+              unsigned offset,
+              TaskMapping &representative);
+
+  void insert(TaskMapping const &mapping,
+              unsigned offset,
+              TaskMapping const &representative);
+
+  void clear();
+
+private:
+  using key_type = std::pair<unsigned, TaskMapping>;
+
+  struct KeyHash
+  {
+    std::size_t operator()(key_type const &key) const
+    { return std::hash<TaskMapping>()(key.second) ^ key.first; }
+  };
+
+  using lru_type = std::list<std::pair<key_type, TaskMapping>>;
+
+  std::size_t _capacity;
+
+  std::atomic<unsigned long long> _hits{0u};
+  std::atomic<unsigned long long> _misses{0u};
+
+  mutable std::mutex _mutex;
+  lru_type _lru;
+  std::unordered_map<key_type, lru_type::iterator, KeyHash> _lru_index;
+};
+
+} // namespace internal
+
+} // namespace mpsym
+
+#endif // GUARD_REPR_CACHE_H
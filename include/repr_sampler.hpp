@@ -0,0 +1,63 @@
+#ifndef GUARD_REPR_SAMPLER_H
+#define GUARD_REPR_SAMPLER_H
+
+#include <mutex>
+#include <random>
+
+#include "arch_graph_automorphisms.hpp"
+#include "bsgs.hpp"
+#include "task_mapping.hpp"
+#include "task_mapping_orbit_generator.hpp"
+#include "timeout.hpp"
+
+namespace mpsym
+{
+
+// draws representatives of orbits of mappings of num_tasks tasks at random,
+// either uniformly over all orbits (by unranking a uniformly drawn rank) or
+// with probability proportional to orbit size (by determining the
+// representative of a uniformly drawn mapping), the random engine is owned
+// by the sampler so that results are reproducible for a fixed seed (if only
+// used by a single thread), in both cases the representatives are the
+// lexicographically minimal orbit elements enumerated by TMORGenerator (and
+// not the canonical forms the architecture graph's repr may yield instead)
+class ReprSampler
+{
+public:
+  using seed_type = std::mt19937_64::result_type;
+
+  ReprSampler(ArchGraphSystem &ags,
+              unsigned num_tasks,
+              bool injective = false,
+              bool weighted = false,
+              seed_type seed = std::random_device{}(),
+              internal::timeout::flag aborted = internal::timeout::unset());
+
+  internal::BSGS::order_type num_orbits() const
+  { return _num_orbits; }
+
+  TaskMapping operator()();
+
+private:
+  TaskMapping sample_uniform();
+  TaskMapping sample_weighted();
+
+  // representatives of weighted samples are determined by backtracking over
+  // the same (full) automorphism group the generator is based on
+  internal::ArchGraphAutomorphisms _automorphisms;
+
+  unsigned _num_tasks;
+  unsigned _degree;
+  bool _injective;
+  bool _weighted;
+
+  TMORGenerator _generator;
+  internal::BSGS::order_type _num_orbits;
+
+  std::mutex _engine_mutex;
+  std::mt19937_64 _engine;
+};
+
+} // namespace mpsym
+
+#endif // GUARD_REPR_SAMPLER_H
@@ -0,0 +1,87 @@
+#ifndef GUARD_REPR_TABLE_H
+#define GUARD_REPR_TABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "perm_set.hpp"
+#include "task_mapping.hpp"
+#include "timeout.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+// orbit representatives of all mappings of num_tasks tasks to degree
+// processors, mappings are encoded as numbers in base degree (first task
+// most significant, so numerical and lexicographical order coincide), the
+// table maps each code to the code of its lexicographically minimal
+// representative and is built by union-find over the orbit graph
+class ReprTable
+{
+public:
+  static constexpr std::uint64_t DEFAULT_MAX_SIZE = 1u << 26;
+
+  ReprTable(PermSet const &generators,
+            unsigned degree,
+            unsigned num_tasks,
+            unsigned num_threads = 1u,
+            std::uint64_t max_size = DEFAULT_MAX_SIZE,
+            timeout::flag aborted = timeout::unset());
+
+  // throws if the file does not exist, is malformed or belongs to a
+  // different architecture (as identified by architecture_hash)
+  ReprTable(std::string const &path, std::uint64_t architecture_hash);
+
+  ReprTable(ReprTable const &) = delete;
+  ReprTable &operator=(ReprTable const &) = delete;
+
+  void save(std::string const &path, std::uint64_t architecture_hash) const;
+
+  unsigned degree() const
+  { return _degree; }
+
+  unsigned num_tasks() const
+  { return _num_tasks; }
+
+  std::uint64_t size() const
+  { return _table.size(); }
+
+  std::uint64_t num_orbits() const
+  { return _num_orbits; }
+
+  // whether mapping is contained in the table, i.e. whether it consists of
+  // num_tasks tasks which all lie in [offset, offset + degree)
+  bool contains(TaskMapping const &mapping, unsigned offset = 0u) const;
+
+  TaskMapping lookup(TaskMapping const &mapping, unsigned offset = 0u) const
+  {
+    auto code(_table[encode(mapping, offset)].load(std::memory_order_relaxed));
+
+    return decode(code, offset);
+  }
+
+private:
+  std::uint32_t encode(TaskMapping const &mapping, unsigned offset = 0u) const;
+  TaskMapping decode(std::uint32_t code, unsigned offset = 0u) const;
+
+  std::uint32_t find(std::uint32_t x);
+  void unite(std::uint32_t x, std::uint32_t y);
+
+  unsigned _degree;
+  unsigned _num_tasks;
+  std::uint64_t _num_orbits = 0u;
+
+  std::vector<std::atomic<std::uint32_t>> _table;
+};
+
+} // namespace internal
+
+} // namespace mpsym
+
+#endif // GUARD_REPR_TABLE_H
@@ -76,6 +76,7 @@ public:
     _sg_end = strong_generators.end();
 
     _beta_it = fundamental_orbit.begin();
+    _beta_begin = _beta_it;
     _beta_end = fundamental_orbit.end();
 
     _schreier_structure = schreier_structure;
@@ -89,6 +90,55 @@ public:
 
   void invalidate() { _valid = false; }
 
+  // position of the queue, this makes it possible to save and restore the
+  // state of an interrupted Schreier-Sims run
+  struct Position
+  {
+    bool valid;
+    bool used;
+    bool exhausted;
+    unsigned beta;
+    unsigned sg;
+  };
+
+  Position position() const
+  {
+    if (!_valid)
+      return {false, false, false, 0u, 0u};
+
+    return {true,
+            _used,
+            _exhausted,
+            static_cast<unsigned>(_beta_it - _beta_begin),
+            static_cast<unsigned>(_sg_it - _sg_begin)};
+  }
+
+  void restore(sg_type const &strong_generators,
+               fo_type const &fundamental_orbit,
+               std::shared_ptr<SchreierStructure> schreier_structure,
+               Position const &pos)
+  {
+    if (!pos.valid) {
+      _valid = false;
+      return;
+    }
+
+    assert(pos.beta <= fundamental_orbit.size());
+    assert(pos.sg <= strong_generators.size());
+
+    _valid = false;
+    update(strong_generators, fundamental_orbit, schreier_structure);
+
+    _beta_it = _beta_begin + pos.beta;
+    _sg_it = _sg_begin + pos.sg;
+
+    _used = pos.used;
+    _exhausted = pos.exhausted;
+
+    if (!_exhausted)
+      _u_beta = u_beta();
+  }
+
   const_iterator begin() { return const_iterator(this); }
   const_iterator end() { return const_iterator(); }
 
@@ -136,6 +186,7 @@ private:
   sg_it_type _sg_end;
 
   fo_it_type _beta_it;
+  fo_it_type _beta_begin;
   fo_it_type _beta_end;
 
   std::shared_ptr<SchreierStructure> _schreier_structure;
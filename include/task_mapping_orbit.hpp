@@ -2,16 +2,22 @@
 #define GUARD_TASK_MAPPING_ORBIT_H
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "packed_task_mapping.hpp"
+#include "perm.hpp"
 #include "perm_set.hpp"
 #include "task_mapping.hpp"
+#include "timeout.hpp"
 #include "util.hpp"
 
 namespace mpsym
@@ -19,40 +25,155 @@ namespace mpsym
 
 class TMO
 {
+public:
+  // called for orbit elements (possibly concurrently, thread is the index of
+  // the calling thread), returning true stops the enumeration early
+  using visitor = std::function<bool(TaskMapping const &, unsigned)>;
+
+private:
   class IterationState
   {
     using hash_type = uint32_t;
 
-  public:
-    IterationState(TMO const *orbit)
-    : _singular(orbit->_generators.empty()),
-      _generators(&orbit->_generators),
-      _unprocessed{orbit->_root}
+    // lazily allocated bitmap over all perfect hash values, memory is only
+    // spent on regions of the hash range actually hit by the orbit, bits can
+    // be set concurrently
+    class ProcessedBitmap
     {
-      current = _unprocessed.begin();
+      static constexpr unsigned PAGE_BITS = 16u;
+      static constexpr hash_type PAGE_MASK = (1u << PAGE_BITS) - 1u;
+      static constexpr unsigned PAGE_WORDS = (1u << PAGE_BITS) / 64u;
+
+      using page_type = std::atomic<uint64_t>;
+
+    public:
+      ProcessedBitmap() = default;
+      ProcessedBitmap(ProcessedBitmap const &) = delete;
+      ProcessedBitmap &operator=(ProcessedBitmap const &) = delete;
+
+      ~ProcessedBitmap()
+      {
+        for (std::size_t i = 0u; i < _num_pages; ++i)
+          delete[] _pages[i].load();
+      }
+
+      void resize(uint64_t size)
+      {
+        _num_pages = (size >> PAGE_BITS) + 1u;
+
+        _pages.reset(new std::atomic<page_type *>[_num_pages]);
+        for (std::size_t i = 0u; i < _num_pages; ++i)
+          _pages[i].store(nullptr);
+      }
+
+      // returns false if the bit was already set
+      bool set(hash_type h)
+      {
+        auto &page_ptr(_pages[h >> PAGE_BITS]);
+
+        page_type *page = page_ptr.load(std::memory_order_acquire);
+        if (!page) {
+          page_type *new_page = new page_type[PAGE_WORDS]();
+
+          if (page_ptr.compare_exchange_strong(page,
+                                               new_page,
+                                               std::memory_order_acq_rel)) {
+            page = new_page;
+          } else {
+            delete[] new_page;
+          }
+        }
+
+        uint64_t bit = uint64_t(1) << (h % 64u);
+
+        return !(page[(h & PAGE_MASK) / 64u].fetch_or(bit) & bit);
+      }
+
+    private:
+      std::unique_ptr<std::atomic<page_type *>[]> _pages;
+      std::size_t _num_pages = 0u;
+    };
+
+    // set of packed mappings that can be inserted into concurrently
+    class ProcessedSet
+    {
+      struct Shard
+      {
+        std::mutex mutex;
+        std::unordered_set<internal::PackedTaskMapping> mappings;
+      };
 
-      if (!_singular)
-        init_hash(orbit->_root);
-    }
+    public:
+      explicit ProcessedSet(unsigned num_shards = 64u)
+      {
+        for (unsigned i = 0u; i < num_shards; ++i)
+          _shards.emplace_back(new Shard);
+      }
+
+      // returns false if the mapping was already contained
+      bool insert(internal::PackedTaskMapping const &mapping)
+      {
+        auto &shard(*_shards[mapping.hash() % _shards.size()]);
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
 
-    std::unordered_set<TaskMapping>::iterator current;
+        return shard.mappings.insert(mapping).second;
+      }
+
+    private:
+      std::vector<std::unique_ptr<Shard>> _shards;
+    };
+
+  public:
+    IterationState(TMO const *orbit);
+
+    TaskMapping current;
 
     void advance();
-    bool exhausted() const;
+    bool exhausted() const
+    { return _exhausted; }
+
+    // replace the current level of the breadth first search by the next one,
+    // the level is expanded by several threads concurrently, visit (if
+    // given) is called for every newly discovered mapping
+    bool expand(visitor const &visit, internal::timeout::flag aborted);
+
+    std::size_t level_size() const
+    { return _perfect_hash ? _level_hashes.size() : _level_mappings.size(); }
 
   private:
-    void init_hash(TaskMapping const &root);
+    void init_hash();
     hash_type perfect_hash(TaskMapping const &mapping) const;
-    static hash_type container_hash_truncated(TaskMapping const &mapping);
+    hash_type perfect_hash_permuted(TaskMapping const &mapping,
+                                    internal::Perm const &perm) const;
+    TaskMapping perfect_unhash(hash_type h) const;
 
-    bool _singular;
-    internal::PermSet const *_generators;
+    TaskMapping level_mapping(std::size_t i) const
+    {
+      return _perfect_hash ? perfect_unhash(_level_hashes[i])
+                           : _level_mappings[i].unpack();
+    }
 
-    std::function<hash_type(TaskMapping)> _hash;
-    std::unordered_map<unsigned, unsigned> _hash_support_map;
+    TMO const *_orbit;
 
-    std::unordered_set<TaskMapping> _unprocessed;
-    std::unordered_set<hash_type> _processed;
+    bool _exhausted = false;
+
+    // if the number of possible mappings over the tasks moved by the
+    // generators fits into hash_type, mappings are represented by their
+    // perfect hash (i.e. the digits in base num_support of these tasks),
+    // otherwise they are stored packed
+    bool _perfect_hash = false;
+    std::vector<unsigned> _hash_positions;
+    std::vector<unsigned> _hash_support;
+    std::vector<unsigned> _hash_support_index;
+
+    std::vector<hash_type> _level_hashes;
+    std::vector<internal::PackedTaskMapping> _level_mappings;
+    std::size_t _level_pos = 0u;
+
+    // only one of these is used, depending on _perfect_hash
+    ProcessedBitmap _processed_hashes;
+    std::unique_ptr<ProcessedSet> _processed_mappings;
   };
 
 public:
@@ -71,7 +192,7 @@ public:
 
   private:
     reference current() override
-    { return *_state->current; }
+    { return _state->current; }
 
     void next() override
     { _state->advance(); }
@@ -82,19 +203,18 @@ public:
     std::shared_ptr<IterationState> _state;
   };
 
-  TMO(TaskMapping const &mapping, internal::PermSet const &generators)
+  // the orbit is enumerated by a level synchronous breadth first search, each
+  // level is expanded by num_threads threads (all hardware threads if zero),
+  // tasks outside of [offset, offset + degree) are never permuted
+  TMO(TaskMapping const &mapping,
+      internal::PermSet const &generators,
+      unsigned offset = 0u,
+      unsigned num_threads = 1u)
   : _root(mapping),
-    _generators(generators)
-  {
-#ifndef NDEBUG
-    if (!generators.empty()) {
-      assert(std::all_of(
-        mapping.begin(),
-        mapping.end(),
-        [&](unsigned task){ return task < generators.degree(); }));
-    }
-#endif
-  }
+    _generators(generators),
+    _offset(offset),
+    _num_threads(num_threads)
+  {}
 
   const_iterator begin() const
   { return const_iterator(std::make_shared<IterationState>(this)); }
@@ -102,14 +222,41 @@ public:
   const_iterator end() const
   { return const_iterator(); }
 
+  // call visit for every orbit element, returns true if it returned true
+  // for any of them
+  bool for_each(visitor const &visit,
+                internal::timeout::flag aborted = internal::timeout::unset()) const;
+
 private:
   TaskMapping _root;
   internal::PermSet _generators;
+  unsigned _offset;
+  unsigned _num_threads;
 };
 
-class TMORs
+class TMORsBase
 {
-  using orbit_reprs_map = std::unordered_map<TaskMapping, unsigned>;
+public:
+  virtual ~TMORsBase() = default;
+
+  virtual std::pair<bool, unsigned> insert(TaskMapping const &mapping) = 0;
+
+  template<typename IT>
+  void insert_all(IT first, IT last)
+  {
+    for (auto it = first; it != last; ++it)
+      insert(*it);
+  }
+
+  virtual bool is_repr(TaskMapping const &mapping) const = 0;
+
+  virtual unsigned num_orbits() const = 0;
+};
+
+class TMORs : public TMORsBase
+{
+  using orbit_reprs_map = std::unordered_map<internal::PackedTaskMapping,
+                                             unsigned>;
 
 public:
   class const_iterator
@@ -125,12 +272,16 @@ public:
 
   private:
     reference current() override
-    { return _it->first; }
+    {
+      _current = _it->first.unpack();
+      return _current;
+    }
 
     void next() override
     { ++_it; }
 
     orbit_reprs_map::const_iterator _it;
+    TaskMapping _current;
   };
 
   bool operator==(TMORs const &rhs) const
@@ -139,25 +290,26 @@ public:
   bool operator!=(TMORs const &rhs) const
   { return !(*this == rhs); }
 
-  std::pair<bool, unsigned> insert(TaskMapping const &mapping);
-
-  template<typename IT>
-  void insert_all(IT first, IT last)
-  {
-    for (auto it = first; it != last; ++it)
-      insert(*it);
-  }
+  std::pair<bool, unsigned> insert(TaskMapping const &mapping) override;
 
-  bool is_repr(TaskMapping const &mapping) const
+  bool is_repr(TaskMapping const &mapping) const override
   {
-    auto it(_orbit_reprs.find(mapping));
+    auto it(_orbit_reprs.find(internal::PackedTaskMapping(mapping)));
 
     return it != _orbit_reprs.end();
   }
 
-  unsigned num_orbits() const
+  unsigned num_orbits() const override
   { return static_cast<unsigned>(_orbit_reprs.size()); }
 
+  // union of several sets of orbit representatives, e.g. produced by
+  // independent workers, orbit indices are assigned in lexicographical order of
+  // the representatives so that the result does not depend on the order of
+  // the inputs, additionally returns one table per input which maps its local
+  // orbit indices to merged orbit indices
+  static std::pair<TMORs, std::vector<std::vector<unsigned>>> merge(
+    std::vector<TMORs const *> const &orbits);
+
   const_iterator begin() const
   { return const_iterator(_orbit_reprs.begin()); }
 
@@ -165,9 +317,9 @@ public:
   { return const_iterator(_orbit_reprs.end()); }
 
 private:
-  std::unordered_set<TaskMapping> orbit_repr_set() const
+  std::unordered_set<internal::PackedTaskMapping> orbit_repr_set() const
   {
-    std::unordered_set<TaskMapping> ret;
+    std::unordered_set<internal::PackedTaskMapping> ret;
     for (auto const &repr : _orbit_reprs)
       ret.insert(repr.first);
 
@@ -177,6 +329,38 @@ private:
   orbit_reprs_map _orbit_reprs;
 };
 
+// can be shared between threads, representatives are distributed over
+// independently locked shards and orbit indices are assigned atomically,
+// they are thus unique and contiguous but depend on the insertion order
+class ConcurrentTMORs : public TMORsBase
+{
+public:
+  explicit ConcurrentTMORs(unsigned num_shards = 64u);
+
+  std::pair<bool, unsigned> insert(TaskMapping const &mapping) override;
+
+  bool is_repr(TaskMapping const &mapping) const override;
+
+  unsigned num_orbits() const override
+  { return _num_orbits.load(); }
+
+  // representatives ordered by orbit index
+  std::vector<TaskMapping> reprs() const;
+
+private:
+  struct Shard
+  {
+    std::mutex mutex;
+    std::unordered_map<internal::PackedTaskMapping, unsigned> orbit_reprs;
+  };
+
+  Shard &shard(internal::PackedTaskMapping const &mapping) const
+  { return *_shards[mapping.hash() % _shards.size()]; }
+
+  std::vector<std::unique_ptr<Shard>> _shards;
+  std::atomic<unsigned> _num_orbits{0u};
+};
+
 } // namespace mpsym
 
 #endif // GUARD_TASK_MAPPING_ORBIT_H
@@ -0,0 +1,74 @@
+#ifndef GUARD_TASK_MAPPING_ORBIT_EXTERNAL_H
+#define GUARD_TASK_MAPPING_ORBIT_EXTERNAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "perm_set.hpp"
+#include "task_mapping.hpp"
+#include "timeout.hpp"
+
+namespace mpsym
+{
+
+// enumerates orbits of task mappings that do not fit into memory: the orbit
+// is explored by a breadth first search whose levels are stored as sorted
+// files in the given directory, since the generators are closed under
+// inversion every level only has to be deduplicated against the two previous
+// ones, which happens by merging sorted runs of at most memory_limit bytes,
+// the orbit is visited level by level and in lexicographical order within
+// every level so that the enumeration order is reproducible
+class ExternalTMO
+{
+public:
+  using visitor = std::function<bool(TaskMapping const &)>;
+
+  static constexpr std::size_t DEFAULT_MEMORY_LIMIT = 1u << 28;
+
+  ExternalTMO(TaskMapping const &mapping,
+              internal::PermSet const &generators,
+              std::string const &directory,
+              std::size_t memory_limit = DEFAULT_MEMORY_LIMIT,
+              unsigned offset = 0u);
+
+  // call visit for every orbit element until it returns true, returns the
+  // number of orbit elements visited
+  std::uint64_t for_each(
+    visitor const &visit,
+    internal::timeout::flag aborted = internal::timeout::unset()) const;
+
+  std::uint64_t size(
+    internal::timeout::flag aborted = internal::timeout::unset()) const
+  { return for_each([](TaskMapping const &){ return false; }, aborted); }
+
+private:
+  class TempFiles;
+
+  std::vector<std::string> expand(std::string const &level,
+                                  TempFiles &files,
+                                  internal::timeout::flag aborted) const;
+
+  std::vector<std::string> merge_runs(std::vector<std::string> runs,
+                                      TempFiles &files,
+                                      internal::timeout::flag aborted) const;
+
+  std::uint64_t merge_level(std::vector<std::string> const &runs,
+                            std::vector<std::string> const &previous_levels,
+                            std::string const &level,
+                            visitor const &visit,
+                            bool &stopped,
+                            internal::timeout::flag aborted) const;
+
+  TaskMapping _root;
+  internal::PermSet _generators;
+  std::string _directory;
+  std::size_t _memory_limit;
+  unsigned _offset;
+};
+
+} // namespace mpsym
+
+#endif // GUARD_TASK_MAPPING_ORBIT_EXTERNAL_H
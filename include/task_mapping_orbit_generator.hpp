@@ -0,0 +1,158 @@
+#ifndef GUARD_TASK_MAPPING_ORBIT_GENERATOR_H
+#define GUARD_TASK_MAPPING_ORBIT_GENERATOR_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "bsgs.hpp"
+#include "iterator.hpp"
+#include "task_mapping.hpp"
+#include "timeout.hpp"
+
+namespace mpsym
+{
+
+// lazily enumerates the lexicographically minimal element of every orbit of
+// task mappings of a fixed length (optionally restricted to mappings
+// starting with a given prefix) by orderly generation: the prefixes of
+// representatives are themselves representatives and a representative p can
+// be extended by x iff x is minimal in its orbit under the pointwise
+// stabilizer of the tasks in p, every representative is thus produced
+// exactly once and no non-representatives are ever constructed
+//
+// since the representatives of a given length are exactly the possible
+// prefixes of longer representatives, enumerating them and passing each one
+// as prefix partitions the enumeration into independent parts
+//
+// the number of representatives below every prefix can be determined via
+// Burnside's lemma applied to the corresponding stabilizer, this yields a
+// bijection between representatives and their positions in the enumeration
+class TMORGenerator
+{
+  struct Node
+  {
+    // base starts with prefix, trivial stabilizer if empty
+    std::shared_ptr<internal::BSGS const> bsgs;
+    std::vector<unsigned> prefix;
+
+    // minimal element and size of every orbit of the stabilizer
+    std::vector<unsigned> orbit_min;
+    std::vector<unsigned> orbit_size;
+
+    bool is_minimal(unsigned x) const
+    { return !bsgs || orbit_min[x] == x; }
+
+    bool is_fixed(unsigned x) const
+    { return !bsgs || orbit_size[x] == 1u; }
+  };
+
+  class IterationState
+  {
+    struct Frame
+    {
+      std::shared_ptr<Node const> node;
+      unsigned next;
+    };
+
+  public:
+    IterationState(TMORGenerator const *generator);
+
+    TaskMapping current;
+
+    void advance();
+    bool exhausted() const
+    { return _exhausted; }
+
+  private:
+    TMORGenerator const *_generator;
+
+    std::vector<unsigned> _mapping;
+    std::vector<unsigned> _mapping_count;
+    std::vector<Frame> _frames;
+
+    bool _exhausted = false;
+  };
+
+public:
+  using value_type = TaskMapping;
+  using const_reference = TaskMapping const &;
+
+  class const_iterator : public util::Iterator<const_iterator, TaskMapping const>
+  {
+  public:
+    const_iterator(std::shared_ptr<IterationState> state = nullptr)
+    : _state(state)
+    {}
+
+    bool operator==(const_iterator const &rhs) const override
+    { return end() && rhs.end(); }
+
+  private:
+    reference current() override
+    { return _state->current; }
+
+    void next() override
+    { _state->advance(); }
+
+    bool end() const
+    { return !_state || _state->exhausted(); }
+
+    std::shared_ptr<IterationState> _state;
+  };
+
+  TMORGenerator(internal::BSGS const &bsgs,
+                unsigned num_tasks,
+                bool injective = false,
+                TaskMapping const &prefix = TaskMapping(),
+                internal::timeout::flag aborted = internal::timeout::unset());
+
+  const_iterator begin() const
+  { return const_iterator(std::make_shared<IterationState>(this)); }
+
+  const_iterator end() const
+  { return const_iterator(); }
+
+  // number of representatives
+  internal::BSGS::order_type size() const;
+
+  // position of a representative in the enumeration
+  internal::BSGS::order_type rank(TaskMapping const &representative) const;
+
+  // representative at the given position in the enumeration
+  TaskMapping unrank(internal::BSGS::order_type rank) const;
+
+private:
+  std::shared_ptr<Node const> child(std::shared_ptr<Node const> const &node,
+                                    unsigned x) const;
+
+  internal::BSGS::order_type count(std::shared_ptr<Node const> const &node,
+                                   unsigned num_distinct_tasks,
+                                   unsigned num_remaining_tasks) const;
+
+  std::vector<internal::BSGS::order_type> fixed_points_distribution(
+    std::shared_ptr<Node const> const &node) const;
+
+  struct FixedPointsCache
+  {
+    std::mutex mutex;
+    std::map<std::vector<unsigned>,
+             std::vector<internal::BSGS::order_type>> distributions;
+  };
+
+  unsigned _degree;
+  unsigned _num_tasks;
+  bool _injective;
+  TaskMapping _prefix;
+  internal::timeout::flag _aborted;
+
+  std::shared_ptr<Node const> _prefix_node;
+  unsigned _prefix_num_distinct_tasks = 0u;
+
+  std::shared_ptr<FixedPointsCache> _fixed_points_cache;
+};
+
+} // namespace mpsym
+
+#endif // GUARD_TASK_MAPPING_ORBIT_GENERATOR_H
@@ -0,0 +1,101 @@
+#ifndef GUARD_TASK_MAPPING_ORBIT_MAPPED_H
+#define GUARD_TASK_MAPPING_ORBIT_MAPPED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "iterator.hpp"
+#include "task_mapping.hpp"
+#include "task_mapping_orbit.hpp"
+
+namespace mpsym
+{
+
+// persistent set of orbit representatives backed by two memory mapped files:
+// an append-only log of representatives ("<path>.log") and an open addressing
+// hash index into that log ("<path>.idx"), reopening the same path continues
+// where the last process left off, the index is rebuilt from the log if the
+// two are found to be inconsistent, every record read from the log is checked
+// against the log's end and std::runtime_error is thrown for a malformed log,
+// orbit indices are 32 bit so at most 2^32 - 1 representatives can be stored
+// (inserting more throws std::runtime_error), not safe to share between
+// threads
+class MappedTMORs : public TMORsBase
+{
+  struct MappedFile;
+
+public:
+  class const_iterator
+  : public util::Iterator<const_iterator, TaskMapping const, true>
+  {
+  public:
+    const_iterator(MappedTMORs const *orbits, std::uint64_t offset)
+    : _orbits(orbits),
+      _offset(offset)
+    {}
+
+    bool operator==(const_iterator const &rhs) const override
+    { return _offset == rhs._offset; }
+
+  private:
+    TaskMapping current() override
+    { return _orbits->record_mapping(_offset); }
+
+    void next() override
+    { _offset = _orbits->record_next(_offset); }
+
+    MappedTMORs const *_orbits;
+    std::uint64_t _offset;
+  };
+
+  explicit MappedTMORs(std::string const &path);
+  ~MappedTMORs();
+
+  MappedTMORs(MappedTMORs const &) = delete;
+  MappedTMORs &operator=(MappedTMORs const &) = delete;
+
+  std::string const &path() const
+  { return _path; }
+
+  std::pair<bool, unsigned> insert(TaskMapping const &mapping) override;
+
+  bool is_repr(TaskMapping const &mapping) const override;
+
+  unsigned num_orbits() const override;
+
+  // flush all changes to disk
+  void sync() const;
+
+  const_iterator begin() const;
+  const_iterator end() const;
+
+private:
+  std::uint64_t find(TaskMapping const &mapping, std::uint64_t hash) const;
+
+  void log_validate() const;
+  bool index_valid() const;
+
+  std::uint32_t const *record(std::uint64_t offset) const;
+  std::uint64_t record_append(TaskMapping const &mapping);
+  TaskMapping record_mapping(std::uint64_t offset) const;
+  std::uint64_t record_next(std::uint64_t offset) const;
+  bool record_equals(std::uint64_t offset, TaskMapping const &mapping) const;
+
+  std::unique_ptr<MappedFile> index_create(std::uint64_t capacity) const;
+  void index_insert(std::uint64_t hash, std::uint64_t offset);
+  void index_replace(std::unique_ptr<MappedFile> index);
+  void index_resize(std::uint64_t capacity);
+  void index_rebuild();
+
+  std::string _path;
+
+  std::unique_ptr<MappedFile> _log;
+  std::unique_ptr<MappedFile> _index;
+};
+
+} // namespace mpsym
+
+#endif // GUARD_TASK_MAPPING_ORBIT_MAPPED_H
@@ -4,6 +4,7 @@
 #include "hash.hpp"
 #include "iterator.hpp"
 #include "numeric.hpp"
+#include "parallel.hpp"
 #include "parse.hpp"
 #include "random.hpp"
 #include "string.hpp"
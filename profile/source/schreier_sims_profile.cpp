@@ -44,7 +44,7 @@ void usage(std::ostream &s)
     "[-h|--help]",
     "-i|--implementation  {gap|mpsym|permlib}",
     "[-s|--schreier-sims] {deterministic|random|random-no-guarantee}",
-    "[-t|--transversals]  {explicit|schreier-trees|shallow-schreier-trees}",
+    "[-t|--transversals]  {explicit|schreier-trees|shallow-schreier-trees|hybrid}",
     "[--bsgs-options      {dont_check_sym,",
     "                      dont_reduce_gens,",
     "                      dont_use_known_order",
@@ -73,7 +73,8 @@ struct ProfileOptions
 
   VariantOption transversals{"explicit",
                              "schreier-trees",
-                             "shallow-schreier-trees"};
+                             "shallow-schreier-trees",
+                             "hybrid"};
 
   VariantOptionSet bsgs_options{"dont_check_sym",
                                 "dont_reduce_gens",
@@ -116,6 +117,8 @@ mpsym::internal::BSGSOptions bsgs_options_mpsym(ProfileOptions const &options)
     bsgs_options.transversals = BSGSOptions::Transversals::SCHREIER_TREES;
   else if (options.transversals.is("shallow-schreier-trees"))
     bsgs_options.transversals = BSGSOptions::Transversals::SHALLOW_SCHREIER_TREES;
+  else if (options.transversals.is("hybrid"))
+    bsgs_options.transversals = BSGSOptions::Transversals::HYBRID;
   else
     throw std::logic_error("unreachable");
 
@@ -1,4 +1,6 @@
+import os
 import pickle
+import tempfile
 import unittest
 from copy import deepcopy
 from itertools import cycle, permutations
@@ -110,6 +112,14 @@ class PermGroupTest(unittest.TestCase):
           else:
             self.assertFalse(elem in self.pg)
 
+    def test_contains_elements(self):
+        elems = [mp.Perm(elem) for elem in permutations(self.dom)]
+
+        for num_threads in 1, 2:
+            contained = self.pg.contains_elements(elems, num_threads=num_threads)
+
+            self.assertEqual(contained, [elem in self.pg_elems for elem in elems])
+
     def test_bool(self):
         self.assertTrue(self.pg)
         self.assertFalse(self.pg_id)
@@ -197,15 +207,119 @@ class ArchGraphSystemTest(unittest.TestCase):
     def test_automorphisms(self):
         self.assertTrue(self.ag.num_automorphisms() == len(self.ag.automorphisms()) == 8192)
 
+    def test_num_orbits(self):
+        ag = mp.ArchGraphAutomorphisms(mp.PermGroup.symmetric(4))
+
+        self.assertEqual(ag.num_orbits(3), 5)
+        self.assertEqual(ag.num_orbits(3, injective=True), 1)
+
+    def test_representatives(self):
+        ag = mp.ArchGraphAutomorphisms(mp.PermGroup.symmetric(4))
+
+        self.assertEqual(list(ag.representatives(3)),
+                         [(0, 0, 0), (0, 0, 1), (0, 1, 0), (0, 1, 1), (0, 1, 2)])
+
+        self.assertEqual(list(ag.representatives(3, injective=True)), [(0, 1, 2)])
+
+        self.assertEqual(list(ag.representatives(3, prefix=(0, 0))),
+                         [(0, 0, 0), (0, 0, 1)])
+
+    def test_rank(self):
+        ag = mp.ArchGraphAutomorphisms(mp.PermGroup.symmetric(4))
+
+        for i, representative in enumerate(ag.representatives(3)):
+            self.assertEqual(ag.rank(representative), i)
+            self.assertEqual(ag.unrank(3, i), representative)
+
+    def test_representative_sampler(self):
+        ag = mp.ArchGraphAutomorphisms(mp.PermGroup.symmetric(4))
+
+        representatives = list(ag.representatives(3))
+
+        for weighted in False, True:
+            sampler = mp.RepresentativeSampler(ag, 3, weighted=weighted, seed=42)
+            sampler_same_seed = mp.RepresentativeSampler(ag, 3, weighted=weighted, seed=42)
+
+            self.assertEqual(sampler.num_orbits, len(representatives))
+
+            for _ in range(100):
+                representative = sampler()
+
+                self.assertIn(representative, representatives)
+                self.assertEqual(representative, sampler_same_seed())
+
     def test_representative(self):
         for orbit in [self.ag_orbit1, self.ag_orbit2]:
             for mapping in orbit:
-                for method in 'iterate', 'orbit':
+                for method in 'iterate', 'orbit', 'backtrack':
                     self.assertEqual(self.ag.representative(mapping, method=method), orbit[0])
 
+    def test_element_table(self):
+        ag = mp.ArchGraphAutomorphisms(mp.PermGroup.symmetric(5))
+
+        mappings = list(permutations(range(5), 3))
+        reprs = [ag.representative(mapping, method='iterate') for mapping in mappings]
+
+        ag.enable_element_table(num_threads=2)
+        self.assertEqual([ag.representative(mapping, method='iterate') for mapping in mappings], reprs)
+
+        ag.disable_element_table()
+
+        with self.assertRaises(ValueError):
+            ag.enable_element_table(max_order=100)
+
+    def test_representative_table(self):
+        ag = mp.ArchGraphAutomorphisms(mp.PermGroup.symmetric(5))
+
+        mappings = list(permutations(range(5), 3))
+        reprs = [ag.representative(mapping) for mapping in mappings]
+
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, 'table')
+
+            for _ in range(2):
+                ag.enable_representative_table(3, path=path, num_threads=2)
+
+                self.assertTrue(os.path.exists(path))
+                self.assertEqual([ag.representative(mapping) for mapping in mappings], reprs)
+
+        ag.disable_representative_table()
+
+        with self.assertRaises(ValueError):
+            ag.enable_representative_table(3, max_size=100)
+
+    def test_representative_batch(self):
+        mappings = self.ag_orbit1 + self.ag_orbit2
+
+        for num_threads in 1, 4:
+            reprs = self.ag.representative_batch(mappings, num_threads=num_threads)
+
+            self.assertEqual(reprs, [self.ag_orbit1[0]] * len(self.ag_orbit1) +
+                                    [self.ag_orbit2[0]] * len(self.ag_orbit2))
+
+            representatives = mp.Representatives()
+            reprs = self.ag.representative_batch(mappings, representatives,
+                                                 num_threads=num_threads)
+
+            self.assertEqual([orbit_index for _, _, orbit_index in reprs],
+                             [0] * len(self.ag_orbit1) + [1] * len(self.ag_orbit2))
+
+    def test_representatives_merge(self):
+        representatives1 = mp.Representatives()
+        self.ag.representative_batch(self.ag_orbit2, representatives1)
+
+        representatives2 = mp.Representatives()
+        self.ag.representative_batch(self.ag_orbit1 + self.ag_orbit2, representatives2)
+
+        merged, remaps = mp.Representatives.merge([representatives1, representatives2])
+
+        self.assertEqual(len(merged), 2)
+        self.assertEqual(remaps, [[1], [0, 1]])
+
     def test_orbit(self):
         for orbit in [self.ag_orbit1, self.ag_orbit2]:
             self.assertCountEqual(list(self.ag.orbit(orbit[0])), orbit)
+            self.assertCountEqual(list(self.ag.orbit(orbit[0], num_threads=4)), orbit)
 
         def orbit_len(orb):
             return sum(1 for _ in orb)
@@ -216,6 +330,14 @@ class ArchGraphSystemTest(unittest.TestCase):
 
           self.assertEqual(orbit_len(ag.orbit(range(n))), factorial(n))
 
+    def test_orbit_size(self):
+        for orbit in [self.ag_orbit1, self.ag_orbit2]:
+            self.assertEqual(self.ag.orbit_size(orbit[0]), len(orbit))
+
+        ag = mp.ArchGraphAutomorphisms(mp.PermGroup.symmetric(16))
+
+        self.assertEqual(ag.orbit_size(range(12)), factorial(16) // factorial(4))
+
     def test_from_nauty(self):
         vertices_super = 4
         adj_super = {0: [1], 1: [2], 2: [3]}
@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
@@ -27,11 +28,14 @@
 #include "arch_graph_cluster.hpp"
 #include "arch_graph_system.hpp"
 #include "arch_uniform_super_graph.hpp"
+#include "element_table.hpp"
 #include "nauty_graph.hpp"
 #include "parse.hpp"
 #include "perm.hpp"
 #include "perm_group.hpp"
 #include "perm_set.hpp"
+#include "repr_sampler.hpp"
+#include "repr_table.hpp"
 #include "task_mapping.hpp"
 #include "task_mapping_orbit.hpp"
 #include "timeout.hpp"
@@ -52,14 +56,18 @@ using mpsym::ArchUniformSuperGraph;
 using mpsym::ReprOptions;
 using mpsym::TaskMapping;
 using mpsym::TMO;
+using mpsym::TMORGenerator;
 using mpsym::TMORs;
+using mpsym::TMORsBase;
 
 using mpsym::internal::ArchGraphAutomorphisms;
 using mpsym::internal::BSGS;
+using mpsym::internal::ElementTable;
 using mpsym::internal::NautyGraph;
 using mpsym::internal::Perm;
 using mpsym::internal::PermGroup;
 using mpsym::internal::PermSet;
+using mpsym::internal::ReprTable;
 
 using mpsym::util::IteratorAdaptor;
 using mpsym::util::parse_perm;
@@ -122,6 +130,8 @@ ReprOptions str_to_repr_options(std::string const &method)
     options.method = ReprOptions::Method::ITERATE;
   } else if (method == "orbit") {
     options.method = ReprOptions::Method::ORBITS;
+  } else if (method == "backtrack") {
+    options.method = ReprOptions::Method::BACKTRACK;
   } else if (method == "local_search_bfs") {
     options.method = ReprOptions::Method::LOCAL_SEARCH;
     options.variant = ReprOptions::Variant::LOCAL_SEARCH_BFS;
@@ -182,6 +192,15 @@ template <>
 struct type_caster<mp::cpp_int> {
   PYBIND11_TYPE_CASTER(mp::cpp_int, _("cpp_int"));
 
+  bool load(handle src, bool)
+  {
+    if (!PyLong_Check(src.ptr()))
+      return false;
+
+    value = mp::cpp_int(str(src).cast<std::string>());
+    return true;
+  }
+
   static handle cast(mp::cpp_int const &src, return_value_policy, handle)
   { return PyLong_FromString(stream(src).c_str(), nullptr, 10); }
 };
@@ -330,6 +349,23 @@ PYBIND11_MODULE_(PYTHON_MODULE_INTERNAL, m)
                                      nullptr);
          },
          "timeout"_a = 0.0)
+    .def("num_orbits",
+         [](ArchGraphSystem &self,
+            unsigned num_tasks,
+            bool injective,
+            double timeout)
+         {
+           return arch_graph_timeout("num_orbits",
+                                     timeout,
+                                     self,
+                                     &ArchGraphSystem::num_orbits,
+                                     num_tasks,
+                                     injective,
+                                     nullptr);
+         },
+         "num_tasks"_a,
+         "injective"_a = false,
+         "timeout"_a = 0.0)
     .def("automorphisms_generators",
          [](ArchGraphSystem &self, double timeout)
          {
@@ -357,6 +393,7 @@ PYBIND11_MODULE_(PYTHON_MODULE_INTERNAL, m)
     .def("orbit",
          [&](ArchGraphSystem &self,
              Sequence<> const &mapping,
+             unsigned num_threads,
              double timeout)
          {
            for (unsigned task : mapping) {
@@ -369,9 +406,66 @@ PYBIND11_MODULE_(PYTHON_MODULE_INTERNAL, m)
                                      self,
                                      &ArchGraphSystem::automorphisms_orbit,
                                      mapping,
+                                     nullptr,
+                                     num_threads);
+         },
+         "mapping"_a, "num_threads"_a = 1, "timeout"_a = 0.0)
+    .def("orbit_size",
+         [&](ArchGraphSystem &self,
+             Sequence<> const &mapping,
+             unsigned offset,
+             double timeout)
+         {
+           return arch_graph_timeout("orbit_size",
+                                     timeout,
+                                     self,
+                                     &ArchGraphSystem::orbit_size,
+                                     mapping,
+                                     offset,
                                      nullptr);
          },
-         "mapping"_a, "timeout"_a = 0.0)
+         "mapping"_a, "offset"_a = 0, "timeout"_a = 0.0)
+    .def("representatives",
+         [&](ArchGraphSystem &self,
+             unsigned num_tasks,
+             bool injective,
+             Sequence<> const &prefix)
+         { return self.orbit_reprs(num_tasks, injective, prefix); },
+         "num_tasks"_a, "injective"_a = false, "prefix"_a = Sequence<>())
+    .def("rank",
+         [&](ArchGraphSystem &self,
+             Sequence<> const &representative,
+             bool injective,
+             double timeout)
+         {
+           return arch_graph_timeout("rank",
+                                     timeout,
+                                     self,
+                                     &ArchGraphSystem::rank,
+                                     representative,
+                                     injective,
+                                     nullptr);
+         },
+         "representative"_a, "injective"_a = false, "timeout"_a = 0.0)
+    .def("unrank",
+         [&](ArchGraphSystem &self,
+             unsigned num_tasks,
+             mp::cpp_int const &rank,
+             bool injective,
+             double timeout)
+         {
+           auto representative(arch_graph_timeout("unrank",
+                                                  timeout,
+                                                  self,
+                                                  &ArchGraphSystem::unrank,
+                                                  num_tasks,
+                                                  rank,
+                                                  injective,
+                                                  nullptr));
+
+           return to_tuple(representative);
+         },
+         "num_tasks"_a, "rank"_a, "injective"_a = false, "timeout"_a = 0.0)
     .def("representative",
          [&](ArchGraphSystem &self,
              Sequence<> const &mapping,
@@ -403,7 +497,7 @@ PYBIND11_MODULE_(PYTHON_MODULE_INTERNAL, m)
          {
            using T = std::tuple<TaskMapping, bool, unsigned>
                      (ArchGraphSystem::*)(TaskMapping const &,
-                                          TMORs &,
+                                          TMORsBase &,
                                           ReprOptions const *,
                                           flag);
 
@@ -427,7 +521,118 @@ PYBIND11_MODULE_(PYTHON_MODULE_INTERNAL, m)
                                   orbit_new,
                                   orbit_index);
          },
-         "mapping"_a, "representatives"_a, "method"_a = "auto", "timeout"_a = 0.0);
+         "mapping"_a, "representatives"_a, "method"_a = "auto", "timeout"_a = 0.0)
+    .def("enable_representative_table",
+         [&](ArchGraphSystem &self,
+             unsigned num_tasks,
+             std::string const &path,
+             unsigned num_threads,
+             std::uint64_t max_size,
+             double timeout)
+         {
+           arch_graph_timeout("enable_representative_table",
+                              timeout,
+                              self,
+                              &ArchGraphSystem::enable_repr_table,
+                              num_tasks,
+                              path,
+                              num_threads,
+                              max_size,
+                              nullptr);
+         },
+         "num_tasks"_a,
+         "path"_a = "",
+         "num_threads"_a = 1,
+         "max_size"_a = ReprTable::DEFAULT_MAX_SIZE,
+         "timeout"_a = 0.0)
+    .def("disable_representative_table", &ArchGraphSystem::disable_repr_table)
+    .def("enable_element_table",
+         [&](ArchGraphSystem &self,
+             unsigned num_threads,
+             std::uint64_t max_order,
+             double timeout)
+         {
+           arch_graph_timeout("enable_element_table",
+                              timeout,
+                              self,
+                              &ArchGraphSystem::enable_element_table,
+                              num_threads,
+                              max_order,
+                              nullptr);
+         },
+         "num_threads"_a = 1,
+         "max_order"_a = ElementTable::DEFAULT_MAX_ORDER,
+         "timeout"_a = 0.0)
+    .def("disable_element_table", &ArchGraphSystem::disable_element_table)
+    .def("representative_batch",
+         [&](ArchGraphSystem &self,
+             Sequence<Sequence<>> const &mappings,
+             std::string const &method,
+             unsigned num_threads,
+             double timeout)
+         {
+           using T = std::vector<TaskMapping>
+                     (ArchGraphSystem::*)(std::vector<TaskMapping> const &,
+                                          ReprOptions const *,
+                                          unsigned,
+                                          flag);
+
+           auto options(str_to_repr_options(method));
+
+           auto reprs(arch_graph_timeout("representative_batch",
+                                         timeout,
+                                         self,
+                                         (T)&ArchGraphSystem::repr_batch,
+                                         std::vector<TaskMapping>(mappings.begin(),
+                                                                  mappings.end()),
+                                         &options,
+                                         num_threads));
+
+           std::vector<py::tuple> res;
+           for (auto const &repr : reprs)
+             res.push_back(to_tuple(repr));
+
+           return res;
+         },
+         "mappings"_a, "method"_a = "auto", "num_threads"_a = 1, "timeout"_a = 0.0)
+    .def("representative_batch",
+         [&](ArchGraphSystem &self,
+             Sequence<Sequence<>> const &mappings,
+             TMORs &representatives,
+             std::string const &method,
+             unsigned num_threads,
+             double timeout)
+         {
+           using T = std::vector<std::tuple<TaskMapping, bool, unsigned>>
+                     (ArchGraphSystem::*)(std::vector<TaskMapping> const &,
+                                          TMORsBase &,
+                                          ReprOptions const *,
+                                          unsigned,
+                                          flag);
+
+           auto options(str_to_repr_options(method));
+
+           auto reprs(arch_graph_timeout("representative_batch",
+                                         timeout,
+                                         self,
+                                         (T)&ArchGraphSystem::repr_batch,
+                                         std::vector<TaskMapping>(mappings.begin(),
+                                                                  mappings.end()),
+                                         representatives,
+                                         &options,
+                                         num_threads));
+
+           std::vector<std::tuple<py::tuple, bool, unsigned>> res;
+           for (auto const &repr : reprs) {
+             res.emplace_back(to_tuple(std::get<0>(repr)),
+                              std::get<1>(repr),
+                              std::get<2>(repr));
+           }
+
+           return res;
+         },
+         "mappings"_a, "representatives"_a, "method"_a = "auto",
+         "num_threads"_a = 1, "timeout"_a = 0.0);
 
   // ArchGraphAutomorphisms
   py::class_<ArchGraphAutomorphisms,
@@ -593,6 +798,41 @@ PYBIND11_MODULE_(PYTHON_MODULE_INTERNAL, m)
                                                                    adaptor.end());
          }, py::keep_alive<0, 1>());
 
+  // TMORGenerator
+  py::class_<TMORGenerator>(m, "RepresentativeGenerator")
+    .def("__iter__",
+         [](TMORGenerator &generator)
+         {
+           IteratorAdaptor<TMORGenerator, py::tuple> adaptor(
+             generator, to_tuple<TaskMapping>);
+
+           return py::make_iterator<py::return_value_policy::copy>(adaptor.begin(),
+                                                                   adaptor.end());
+         }, py::keep_alive<0, 1>());
+
+  // ReprSampler
+  py::class_<ReprSampler>(m, "RepresentativeSampler")
+    .def(py::init(
+           [](ArchGraphSystem &ags,
+              unsigned num_tasks,
+              bool injective,
+              bool weighted,
+              py::object const &seed)
+           {
+             if (seed.is_none())
+               return new ReprSampler(ags, num_tasks, injective, weighted);
+
+             return new ReprSampler(ags, num_tasks, injective, weighted,
+                                    seed.cast<ReprSampler::seed_type>());
+           }),
+         "arch_graph"_a, "num_tasks"_a, "injective"_a = false,
+         "weighted"_a = false, "seed"_a = py::none(),
+         py::keep_alive<1, 2>())
+    .def_property_readonly("num_orbits", &ReprSampler::num_orbits)
+    .def("__call__",
+         [](ReprSampler &sampler)
+         { return to_tuple(sampler()); });
+
   // TMORs
   py::class_<TMORs>(m, "Representatives")
     .def(py::init<>())
@@ -606,7 +846,8 @@ PYBIND11_MODULE_(PYTHON_MODULE_INTERNAL, m)
     .def("__contains__",
          [](TMORs const &orbits, Sequence<> const &mapping)
          { return orbits.is_repr(mapping); },
-         "mapping"_a);
+         "mapping"_a)
+    .def_static("merge", &TMORs::merge, "representatives"_a);
 
   // Perm
   py::class_<Perm>(m, "Perm")
@@ -781,6 +1022,17 @@ PYBIND11_MODULE_(PYTHON_MODULE_INTERNAL, m)
          [](PermGroup const &self, std::string const &p)
          { return self.contains_element(str_to_perm(self.degree(), p)); },
          "perm"_a)
+    .def("contains_elements",
+         [](PermGroup const &self, Sequence<Perm> const &perms, unsigned num_threads)
+         {
+           for (auto const &p : perms) {
+             if (p.degree() != self.degree())
+               throw std::invalid_argument("mismatched degrees");
+           }
+
+           return self.contains_elements(perms, num_threads);
+         },
+         "perms"_a, "num_threads"_a = 1)
     .def("__bool__",
          [](PermGroup const &self)
          { return !self.is_trivial(); })
@@ -90,7 +90,7 @@ ArchGraphCluster::automorphisms_(AutomorphismOptions const *options,
 TaskMapping
 ArchGraphCluster::repr_(TaskMapping const &mapping_,
                         ReprOptions const *options_,
-                        TMORs *,
+                        TMORsBase *,
                         timeout::flag aborted)
 {
   auto options(ReprOptions::fill_defaults(options_));
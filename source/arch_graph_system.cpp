@@ -1,6 +1,9 @@
 #include <algorithm>
 #include <atomic>
+#include <cassert>
 #include <cmath>
+#include <cstdint>
+#include <fstream>
 #include <functional>
 #include <limits>
 #include <memory>
@@ -8,7 +11,9 @@
 #include <numeric>
 #include <queue>
 #include <random>
+#include <string>
 #include <stdexcept>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -20,21 +25,115 @@
 #include "arch_graph_system.hpp"
 #include "arch_uniform_super_graph.hpp"
 #include "bsgs.hpp"
+#include "dbg.hpp"
+#include "element_table.hpp"
+#include "orbit.hpp"
+#include "packed_task_mapping.hpp"
+#include "parallel.hpp"
 #include "perm.hpp"
 #include "perm_group.hpp"
 #include "perm_set.hpp"
+#include "repr_cache.hpp"
+#include "repr_table.hpp"
 #include "task_mapping.hpp"
 #include "task_mapping_orbit.hpp"
+#include "task_mapping_orbit_external.hpp"
+#include "task_mapping_orbit_generator.hpp"
 #include "timeout.hpp"
 #include "util.hpp"
 
 using boost::multiprecision::pow;
 
+namespace
+{
+
+// needs to be stable across processes, std::hash is not guaranteed to be
+std::uint64_t architecture_hash(std::string const &json)
+{
+  std::uint64_t h = 0xcbf29ce484222325ull;
+
+  for (char c : json) {
+    h ^= static_cast<unsigned char>(c);
+    h *= 0x100000001b3ull;
+  }
+
+  return h;
+}
+
+// the processors used by tasks in [offset, offset + degree) in order of their
+// first occurrence, level_min is set to the number of them already used by
+// the first minimal_prefix tasks
+std::vector<unsigned> backtrack_prefix(mpsym::TaskMapping const &tasks,
+                                       unsigned offset,
+                                       unsigned degree,
+                                       unsigned minimal_prefix,
+                                       unsigned &level_min)
+{
+  std::vector<unsigned> prefix;
+  std::vector<bool> in_prefix(degree, false);
+
+  level_min = 0u;
+
+  for (unsigned i = 0u; i < tasks.size(); ++i) {
+    unsigned task = tasks[i];
+
+    if (task < offset || task >= degree + offset)
+      continue;
+
+    unsigned x = task - offset;
+    if (!in_prefix[x]) {
+      prefix.push_back(x);
+      in_prefix[x] = true;
+
+      if (i < minimal_prefix)
+        ++level_min;
+    }
+  }
+
+  return prefix;
+}
+
+} // anonymous namespace
+
 namespace mpsym
 {
 
 using namespace internal;
 
+ArchGraphSystem::ArchGraphSystem(ArchGraphSystem const &other)
+{ *this = other; }
+
+ArchGraphSystem &ArchGraphSystem::operator=(ArchGraphSystem const &other)
+{
+  if (this == &other)
+    return *this;
+
+  std::lock(_automorphisms_mutex, other._automorphisms_mutex);
+  std::lock_guard<std::mutex> lock(_automorphisms_mutex, std::adopt_lock);
+  std::lock_guard<std::mutex> lock_other(other._automorphisms_mutex,
+                                         std::adopt_lock);
+
+  _automorphisms = other._automorphisms;
+  _automorphism_generators = other._automorphism_generators;
+  _automorphisms_valid = other._automorphisms_valid.load();
+
+  _automorphisms_is_symmetric = other._automorphisms_is_symmetric;
+  _automorphisms_is_symmetric_valid = other._automorphisms_is_symmetric_valid.load();
+
+  _automorphisms_smp = other._automorphisms_smp;
+  _automorphisms_lmp = other._automorphisms_lmp;
+
+  if (other._repr_cache)
+    _repr_cache = std::make_shared<ReprCache>(other._repr_cache->capacity());
+  else
+    _repr_cache.reset();
+
+  _repr_table = other._repr_table;
+  _element_table = other._element_table;
+
+  return *this;
+}
+
 std::shared_ptr<ArchGraphSystem> ArchGraphSystem::expand_automorphisms() const
 {
   auto const *ag(dynamic_cast<ArchGraph const *>(this));
@@ -73,34 +172,275 @@ std::shared_ptr<ArchGraphSystem> ArchGraphSystem::expand_automorphisms() const
 TMO ArchGraphSystem::automorphisms_orbit(
   TaskMapping const &mapping,
   AutomorphismOptions const *options,
+  unsigned num_threads,
   timeout::flag aborted)
 {
   automorphisms(options, aborted);
 
-  return TMO(mapping, _automorphism_generators.with_inverses());
+  return TMO(mapping, _automorphism_generators.with_inverses(), 0u, num_threads);
 }
 
-bool ArchGraphSystem::automorphisms_symmetric(ReprOptions const *options)
+ExternalTMO ArchGraphSystem::automorphisms_orbit_external(
+  TaskMapping const &mapping,
+  std::string const &directory,
+  std::size_t memory_limit,
+  AutomorphismOptions const *options,
+  timeout::flag aborted)
 {
-  TaskMapping representative;
+  automorphisms(options, aborted);
+
+  return ExternalTMO(mapping, _automorphism_generators, directory, memory_limit);
+}
 
-  if (options->optimize_symmetric && !_automorphisms_is_symmetric_valid) {
-    _automorphisms_is_symmetric = _automorphisms.is_symmetric();
+BSGS::order_type ArchGraphSystem::orbit_size(TaskMapping const &mapping,
+                                             unsigned offset,
+                                             AutomorphismOptions const *options,
+                                             timeout::flag aborted)
+{
+  auto group(automorphisms(options, aborted));
+
+  unsigned degree = group.degree();
+
+  // tasks outside of [offset, offset + degree) are never permuted
+  std::vector<unsigned> prefix;
+  std::vector<bool> in_prefix(degree, false);
+
+  for (unsigned task : mapping) {
+    if (task < offset || task >= offset + degree)
+      continue;
 
-    if (_automorphisms_is_symmetric) {
-      _automorphisms_smp = _automorphism_generators.smallest_moved_point();
-      _automorphisms_lmp = _automorphism_generators.largest_moved_point();
+    if (!in_prefix[task - offset]) {
+      prefix.push_back(task - offset);
+      in_prefix[task - offset] = true;
     }
+  }
+
+  if (group.is_trivial())
+    return 1;
+
+  // the stabilizer of the mapping is the pointwise stabilizer of the
+  // processors it uses, with these as base prefix its index in the
+  // automorphism group is the product of the first basic orbit sizes
+  BSGS bsgs(group.bsgs());
+  bsgs.base_change(prefix);
+
+  BSGS::order_type size = 1;
+
+  for (unsigned i = 0u; i < prefix.size(); ++i)
+    size *= bsgs.orbit_size(i);
+
+  return size;
+}
+
+TMORGenerator ArchGraphSystem::orbit_reprs(unsigned num_tasks,
+                                           bool injective,
+                                           TaskMapping const &prefix,
+                                           AutomorphismOptions const *options,
+                                           timeout::flag aborted)
+{
+  auto group(automorphisms(options, aborted));
+
+  return TMORGenerator(group.bsgs(), num_tasks, injective, prefix, aborted);
+}
+
+BSGS::order_type ArchGraphSystem::num_orbits(unsigned num_tasks,
+                                             bool injective,
+                                             AutomorphismOptions const *options,
+                                             timeout::flag aborted)
+{
+  return orbit_reprs(
+    num_tasks, injective, TaskMapping(), options, aborted).size();
+}
+
+BSGS::order_type ArchGraphSystem::rank(TaskMapping const &representative,
+                                       bool injective,
+                                       AutomorphismOptions const *options,
+                                       timeout::flag aborted)
+{
+  return orbit_reprs(
+    representative.size(), injective, TaskMapping(), options, aborted).rank(
+      representative);
+}
+
+TaskMapping ArchGraphSystem::unrank(unsigned num_tasks,
+                                    BSGS::order_type const &rank,
+                                    bool injective,
+                                    AutomorphismOptions const *options,
+                                    timeout::flag aborted)
+{
+  return orbit_reprs(
+    num_tasks, injective, TaskMapping(), options, aborted).unrank(rank);
+}
+
+std::vector<TaskMapping> ArchGraphSystem::repr_batch(
+  std::vector<TaskMapping> const &mappings,
+  ReprOptions const *options,
+  unsigned num_threads,
+  timeout::flag aborted)
+{ return repr_batch_(mappings, options, nullptr, num_threads, aborted); }
+
+std::vector<std::tuple<TaskMapping, bool, unsigned>>
+ArchGraphSystem::repr_batch(std::vector<TaskMapping> const &mappings,
+                            TMORsBase &orbits,
+                            ReprOptions const *options,
+                            unsigned num_threads,
+                            timeout::flag aborted)
+{
+  auto representatives(
+    repr_batch_(mappings, options, &orbits, num_threads, aborted));
 
-    _automorphisms_is_symmetric_valid = true;
+  // orbit indices are assigned in input order
+  std::vector<std::tuple<TaskMapping, bool, unsigned>> res;
+  res.reserve(representatives.size());
+
+  for (auto &representative : representatives) {
+    auto ins(orbits.insert(representative));
+
+    res.emplace_back(std::move(representative), ins.first, ins.second);
   }
 
-  return options->optimize_symmetric && _automorphisms_is_symmetric;
+  return res;
+}
+
+std::vector<TaskMapping> ArchGraphSystem::repr_batch_(
+  std::vector<TaskMapping> const &mappings,
+  ReprOptions const *options,
+  TMORsBase *orbits,
+  unsigned num_threads,
+  timeout::flag aborted)
+{
+  std::vector<TaskMapping> representatives(mappings.size());
+
+  if (mappings.empty())
+    return representatives;
+
+  if (!repr_ready_())
+    init_repr();
+
+  // orbits is not modified until all workers are done
+  util::parallel_for(
+    mappings.size(),
+    num_threads,
+    [&](std::size_t begin, std::size_t end, unsigned)
+    {
+      for (std::size_t i = begin; i < end; ++i)
+        representatives[i] = repr_cached(mappings[i], options, orbits, aborted);
+    });
+
+  return representatives;
+}
+
+void ArchGraphSystem::enable_repr_table_(unsigned num_tasks,
+                                         std::string const &path,
+                                         unsigned num_threads,
+                                         std::uint64_t max_size,
+                                         AutomorphismOptions const *options,
+                                         timeout::flag aborted)
+{
+  automorphisms(options, aborted);
+
+  std::uint64_t hash = 0u;
+
+  if (!path.empty()) {
+    hash = architecture_hash(to_json());
+
+    std::ifstream exists(path);
+    if (exists) {
+      try {
+        auto table(std::make_shared<ReprTable>(path, hash));
+
+        if (table->num_tasks() == num_tasks &&
+            table->degree() == _automorphisms.degree()) {
+          _repr_table = table;
+          return;
+        }
+      } catch (std::runtime_error const &e) {
+        DBG(WARN) << "Failed to load representative table: " << e.what();
+      }
+    }
+  }
+
+  auto table(std::make_shared<ReprTable>(_automorphism_generators,
+                                         _automorphisms.degree(),
+                                         num_tasks,
+                                         num_threads,
+                                         max_size,
+                                         aborted));
+
+  if (!path.empty())
+    table->save(path, hash);
+
+  _repr_table = table;
+}
+
+void ArchGraphSystem::enable_element_table_(unsigned num_threads,
+                                            std::uint64_t max_order,
+                                            AutomorphismOptions const *options,
+                                            timeout::flag aborted)
+{
+  automorphisms(options, aborted);
+
+  _element_table = std::make_shared<ElementTable>(
+    _automorphisms, num_threads, max_order, aborted);
+}
+
+bool ArchGraphSystem::automorphisms_symmetric(ReprOptions const *options)
+{
+  if (!options->optimize_symmetric)
+    return false;
+
+  if (!_automorphisms_is_symmetric_valid.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(_automorphisms_mutex);
+
+    if (!_automorphisms_is_symmetric_valid.load(std::memory_order_relaxed)) {
+      _automorphisms_is_symmetric = _automorphisms.is_symmetric();
+
+      if (_automorphisms_is_symmetric) {
+        _automorphisms_smp = _automorphism_generators.smallest_moved_point();
+        _automorphisms_lmp = _automorphism_generators.largest_moved_point();
+      }
+
+      _automorphisms_is_symmetric_valid.store(true, std::memory_order_release);
+    }
+  }
+
+  return _automorphisms_is_symmetric;
+}
+
+TaskMapping ArchGraphSystem::repr_cached(TaskMapping const &mapping,
+                                         ReprOptions const *options_,
+                                         TMORsBase *orbits,
+                                         timeout::flag aborted)
+{
+  if (!_repr_cache && !_repr_table)
+    return repr_(mapping, options_, orbits, aborted);
+
+  auto options(ReprOptions::fill_defaults(options_));
+
+  // local search does not necessarily find the correct representative
+  if (options.method == ReprOptions::Method::LOCAL_SEARCH)
+    return repr_(mapping, &options, orbits, aborted);
+
+  if (_repr_table && _repr_table->contains(mapping, options.offset))
+    return _repr_table->lookup(mapping, options.offset);
+
+  if (!_repr_cache)
+    return repr_(mapping, &options, orbits, aborted);
+
+  TaskMapping representative;
+  if (_repr_cache->lookup(mapping, options.offset, representative))
+    return representative;
+
+  representative = repr_(mapping, &options, orbits, aborted);
+
+  _repr_cache->insert(mapping, options.offset, representative);
+
+  return representative;
 }
 
 TaskMapping ArchGraphSystem::repr_(TaskMapping const &mapping,
                                    ReprOptions const *options_,
-                                   TMORs *orbits,
+                                   TMORsBase *orbits,
                                    timeout::flag aborted)
 {
   automorphisms();
@@ -117,6 +457,8 @@ TaskMapping ArchGraphSystem::repr_(TaskMapping const &mapping,
            min_elem_iterate(mapping, &options, orbits, aborted) :
          options.method == ReprOptions::Method::ORBITS ?
            min_elem_orbits(mapping, &options, orbits, aborted) :
+         options.method == ReprOptions::Method::BACKTRACK ?
+           min_elem_backtrack(mapping, &options, aborted) :
          options.method == ReprOptions::Method::LOCAL_SEARCH ?
            options.variant == ReprOptions::Variant::LOCAL_SEARCH_SA_LINEAR ?
              min_elem_local_search_sa(mapping, &options) :
@@ -126,9 +468,18 @@ TaskMapping ArchGraphSystem::repr_(TaskMapping const &mapping,
 
 TaskMapping ArchGraphSystem::min_elem_iterate(TaskMapping const &tasks,
                                               ReprOptions const *options,
-                                              TMORs *orbits,
+                                              TMORsBase *orbits,
                                               timeout::flag aborted) const
 {
+  if (_element_table) {
+    return _element_table->min_elem(
+      tasks,
+      options->offset,
+      [&](TaskMapping const &representative)
+      { return is_repr(representative, options, orbits); },
+      aborted);
+  }
+
   TaskMapping representative(tasks);
 
   for (auto it = _automorphisms.begin(); it != _automorphisms.end(); ++it) {
@@ -150,39 +501,174 @@ TaskMapping ArchGraphSystem::min_elem_iterate(TaskMapping const &tasks,
 
 TaskMapping ArchGraphSystem::min_elem_orbits(TaskMapping const &tasks,
                                              ReprOptions const *options,
-                                             TMORs *orbits,
+                                             TMORsBase *orbits,
                                              timeout::flag aborted) const
 {
-  TaskMapping representative(tasks);
+  unsigned num_threads = options->orbits_num_threads;
+  if (num_threads == 0u)
+    num_threads = util::hardware_threads();
 
-  std::unordered_set<TaskMapping> unprocessed, processed;
+  // every thread keeps track of the smallest orbit element it has seen
+  std::vector<TaskMapping> representatives(num_threads, tasks);
 
-  unprocessed.insert(tasks);
+  std::mutex found_mutex;
+  TaskMapping found;
 
-  while (!unprocessed.empty()) {
-    if (timeout::is_set(aborted))
-      throw timeout::AbortedError("min_elem_orbits");
+  TMO orbit(tasks, _automorphism_generators, options->offset, num_threads);
+
+  bool stopped = orbit.for_each(
+    [&](TaskMapping const &mapping, unsigned thread)
+    {
+      if (mapping.less_than(representatives[thread]))
+        representatives[thread] = mapping;
 
-    auto it(unprocessed.begin());
-    TaskMapping current(*it);
-    unprocessed.erase(it);
+      if (!is_repr(mapping, options, orbits))
+        return false;
 
-    processed.insert(current);
+      std::lock_guard<std::mutex> lock(found_mutex);
+      found = mapping;
 
-    if (current.less_than(representative))
-      representative = current;
+      return true;
+    },
+    aborted);
+
+  if (stopped)
+    return found;
+
+  return *std::min_element(
+    representatives.begin(),
+    representatives.end(),
+    [](TaskMapping const &lhs, TaskMapping const &rhs)
+    { return lhs.less_than(rhs); });
+}
+
+IncrementalRepr ArchGraphSystem::repr_element(TaskMapping const &mapping,
+                                              ReprOptions const *options_,
+                                              timeout::flag aborted)
+{
+  automorphisms();
+
+  auto options(ReprOptions::fill_defaults(options_));
 
-    for (Perm const &gen : _automorphism_generators) {
-      TaskMapping next(current.permuted(gen, options->offset));
+  BSGS chain(_automorphisms.bsgs());
 
-      if (is_repr(next, options, orbits))
-        return next;
-      else if (processed.find(next) == processed.end())
-        unprocessed.insert(next);
+  Perm element(min_elem_backtrack_element(
+    mapping, options.offset, 0u, chain, aborted));
+
+  TaskMapping representative(mapping.permuted(element, options.offset));
+
+  align_chain(representative, options.offset, chain);
+
+  return {representative, element, chain};
+}
+
+IncrementalRepr ArchGraphSystem::repr_update(TaskMapping const &mapping,
+                                             IncrementalRepr const &previous,
+                                             unsigned task,
+                                             unsigned pe,
+                                             ReprOptions const *options_,
+                                             timeout::flag aborted)
+{
+  automorphisms();
+
+  auto options(ReprOptions::fill_defaults(options_));
+
+  assert(task < mapping.size());
+  assert(previous.representative ==
+         mapping.permuted(previous.element, options.offset));
+
+  unsigned degree = _automorphisms.degree();
+
+  // the moved mapping transformed by element only differs from the previous
+  // representative in the moved task, all positions before it are thus
+  // already minimal and only the remaining ones have to be re-minimized, the
+  // chain's base already starts with the processors used by them so that
+  // only the levels after these are changed
+  TaskMapping moved(previous.representative);
+
+  if (pe >= options.offset && pe < degree + options.offset)
+    moved[task] = previous.element[pe - options.offset] + options.offset;
+  else
+    moved[task] = pe;
+
+  BSGS chain(previous.chain);
+
+  Perm element_moved(min_elem_backtrack_element(
+    moved, options.offset, task, chain, aborted));
+
+  TaskMapping representative(moved.permuted(element_moved, options.offset));
+
+  align_chain(representative, options.offset, chain);
+
+  return {representative, previous.element * element_moved, chain};
+}
+
+TaskMapping ArchGraphSystem::min_elem_backtrack(TaskMapping const &tasks,
+                                                ReprOptions const *options,
+                                                timeout::flag aborted) const
+{
+  BSGS chain(_automorphisms.bsgs());
+
+  Perm g(min_elem_backtrack_element(
+    tasks, options->offset, 0u, chain, aborted));
+
+  return tasks.permuted(g, options->offset);
+}
+
+Perm ArchGraphSystem::min_elem_backtrack_element(TaskMapping const &tasks,
+                                                 unsigned offset,
+                                                 unsigned minimal_prefix,
+                                                 BSGS &chain,
+                                                 timeout::flag aborted) const
+{
+  unsigned degree = _automorphisms.degree();
+
+  if (_automorphisms.is_trivial())
+    return Perm(degree);
+
+  // the tasks that can be moved, in order of their first occurrence
+  unsigned level_min;
+  auto prefix(
+    backtrack_prefix(tasks, offset, degree, minimal_prefix, level_min));
+
+  // with these tasks as base prefix, the elements mapping the first i tasks
+  // to their minimal images form a single coset of the i-th stabilizer, the
+  // search tree is thus pruned down to a single path: at every level, the
+  // coset whose image of the next task exceeds the current best is discarded
+  chain.base_change(prefix);
+
+  Perm g(degree);
+
+  // if the first minimal_prefix tasks are already minimal, the identity
+  // coset is chosen on all corresponding levels
+  for (unsigned i = level_min; i < prefix.size(); ++i) {
+    if (timeout::is_set(aborted))
+      throw timeout::AbortedError("min_elem_backtrack");
+
+    unsigned o_min = prefix[i];
+
+    for (unsigned o : chain.orbit(i)) {
+      if (g[o] < g[o_min])
+        o_min = o;
     }
+
+    if (o_min != prefix[i])
+      g = chain.transversal(i, o_min) * g;
   }
 
-  return representative;
+  return g;
+}
+
+void ArchGraphSystem::align_chain(TaskMapping const &tasks,
+                                  unsigned offset,
+                                  BSGS &chain) const
+{
+  if (_automorphisms.is_trivial())
+    return;
+
+  unsigned level_min;
+  chain.base_change(backtrack_prefix(
+    tasks, offset, _automorphisms.degree(), 0u, level_min));
 }
 
 TaskMapping ArchGraphSystem::min_elem_local_search(
@@ -235,8 +721,14 @@ PermSet ArchGraphSystem::local_search_augment_gens(
   auto generators(_automorphism_generators);
 
   // append random generators
-  for (unsigned i = 0u; i < options->local_search_append_generators; ++i)
-    generators.insert(_automorphisms.random_element());
+  for (unsigned i = 0u; i < options->local_search_append_generators; ++i) {
+    if (_element_table) {
+      thread_local auto re(util::random_engine());
+      generators.insert(_element_table->random_element(re));
+    } else {
+      generators.insert(_automorphisms.random_element());
+    }
+  }
 
   return generators;
 }
@@ -248,7 +740,7 @@ TaskMapping ArchGraphSystem::min_elem_local_search_sa(
   using namespace std::placeholders;
 
   // probability distributions
-  static auto re(util::random_engine());
+  thread_local auto re(util::random_engine());
 
   std::uniform_real_distribution<> d_prob(0.0, 1.0);
 
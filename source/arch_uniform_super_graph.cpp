@@ -169,7 +169,7 @@ ArchUniformSuperGraph::init_repr_(AutomorphismOptions const *options,
     _sigmas_proto = wreath_product_action_proto(options, aborted);
   }
 
-  _sigmas_valid = true;
+  _sigmas_valid.store(true, std::memory_order_release);
 }
 
 bool
@@ -177,7 +177,7 @@ ArchUniformSuperGraph::repr_ready_() const
 {
   return _subsystem_super_graph->automorphisms_ready() &&
          _subsystem_proto->automorphisms_ready() &&
-         _sigmas_valid;
+         _sigmas_valid.load(std::memory_order_acquire);
 }
 
 void
@@ -191,7 +191,7 @@ ArchUniformSuperGraph::reset_repr_()
 TaskMapping
 ArchUniformSuperGraph::repr_(TaskMapping const &mapping,
                              ReprOptions const *options,
-                             TMORs *,
+                             TMORsBase *,
                              timeout::flag aborted)
 {
   TaskMapping representative(mapping);
@@ -205,4 +205,101 @@ ArchUniformSuperGraph::repr_(TaskMapping const &mapping,
   return _sigma_super_graph->repr(representative, options, aborted);
 }
 
+void
+ArchUniformSuperGraph::enable_repr_table_(unsigned num_tasks,
+                                          std::string const &path,
+                                          unsigned num_threads,
+                                          std::uint64_t max_size,
+                                          AutomorphismOptions const *options,
+                                          timeout::flag aborted)
+{
+  // representatives are determined by the groups set up by init_repr
+  init_repr(options, aborted);
+
+  auto sigmas_(sigmas());
+
+  for (auto i = 0u; i < sigmas_.size(); ++i) {
+    sigmas_[i]->enable_repr_table(
+      num_tasks,
+      path.empty() ? path : path + "." + std::to_string(i),
+      num_threads,
+      max_size,
+      options,
+      aborted);
+  }
+}
+
+void
+ArchUniformSuperGraph::disable_repr_table_()
+{
+  if (!repr_ready_())
+    return;
+
+  for (auto const &sigma : sigmas())
+    sigma->disable_repr_table();
+}
+
+bool
+ArchUniformSuperGraph::repr_table_enabled_() const
+{
+  if (!repr_ready_())
+    return false;
+
+  for (auto const &sigma : sigmas()) {
+    if (!sigma->repr_table_enabled())
+      return false;
+  }
+
+  return true;
+}
+
+void
+ArchUniformSuperGraph::enable_element_table_(unsigned num_threads,
+                                             std::uint64_t max_order,
+                                             AutomorphismOptions const *options,
+                                             timeout::flag aborted)
+{
+  // representatives are determined by the groups set up by init_repr
+  init_repr(options, aborted);
+
+  for (auto const &sigma : sigmas())
+    sigma->enable_element_table(num_threads, max_order, options, aborted);
+}
+
+void
+ArchUniformSuperGraph::disable_element_table_()
+{
+  if (!repr_ready_())
+    return;
+
+  for (auto const &sigma : sigmas())
+    sigma->disable_element_table();
+}
+
+bool
+ArchUniformSuperGraph::element_table_enabled_() const
+{
+  if (!repr_ready_())
+    return false;
+
+  for (auto const &sigma : sigmas()) {
+    if (!sigma->element_table_enabled())
+      return false;
+  }
+
+  return true;
+}
+
+std::vector<std::shared_ptr<ArchGraphAutomorphisms>>
+ArchUniformSuperGraph::sigmas() const
+{
+  if (_super_graph_trivial || _proto_trivial)
+    return {_sigma_total};
+
+  auto sigmas(_sigmas_proto);
+  sigmas.push_back(_sigma_super_graph);
+
+  return sigmas;
+}
+
 } // namespace mpsym
@@ -14,10 +14,12 @@
 #include "dbg.hpp"
 #include "dump.hpp"
 #include "orbit.hpp"
+#include "parallel.hpp"
 #include "perm.hpp"
 #include "perm_set.hpp"
 #include "pr_randomizer.hpp"
 #include "explicit_transversals.hpp"
+#include "hybrid_transversals.hpp"
 #include "schreier_structure.hpp"
 #include "schreier_tree.hpp"
 
@@ -45,8 +47,10 @@ void BSGSTransversalsBase::update_schreier_structure(
 
   Orbit::generate(root, generators, ss);
 
-  if (i < _schreier_structures.size())
+  if (i < _schreier_structures.size()) {
     _schreier_structures[i].swap(ss);
+    return;
+  }
 
   assert(i == _schreier_structures.size());
 
@@ -61,9 +65,25 @@ void BSGSTransversalsBase::insert_schreier_structure(
   update_schreier_structure(i, root, degree, generators);
 }
 
+BSGSHybridTransversals::BSGSHybridTransversals(std::size_t budget)
+: _budget(std::make_shared<HybridTransversalsBudget>(budget))
+{}
+
+std::shared_ptr<SchreierStructure>
+BSGSHybridTransversals::make_schreier_structure(
+  unsigned root, unsigned degree, PermSet const &generators)
+{
+  return std::make_shared<HybridTransversals>(
+    degree, root, generators, _budget);
+}
+
 BSGS::BSGS(unsigned degree)
 : _degree(degree)
-{ assert(degree > 0); }
+{
+  assert(degree > 0);
+
+  update_strong_generator_indices();
+}
 
 BSGS::BSGS(unsigned degree,
            PermSet const &generators,
@@ -73,8 +93,10 @@ BSGS::BSGS(unsigned degree,
 {
   assert(degree > 0);
 
-  if (generators.trivial())
+  if (generators.trivial()) {
+    update_strong_generator_indices();
     return;
+  }
 
   generators.assert_degree(degree);
 
@@ -104,6 +126,9 @@ BSGS::BSGS(unsigned degree,
   else
     construct_unknown(generators, &options, aborted);
 
+  update_strong_generator_indices();
+  update_order();
+
   DBG(DEBUG) << "=> B = " << _base;
   DBG(DEBUG) << "=> SGS = " << _strong_generators;
 
@@ -140,25 +165,42 @@ BSGS::BSGS(unsigned degree,
   }
 
   assert(sgs.empty());
+
+  update_strong_generator_indices();
+  update_order();
 }
 
-BSGS::order_type BSGS::order() const
+BSGS::BSGS(BSGS const &other)
+: _degree(other._degree),
+  _base(other._base),
+  _transversals(other._transversals ? other._transversals->clone() : nullptr),
+  _strong_generators(other._strong_generators),
+  _strong_generator_indices(other._strong_generator_indices),
+  _orbit_sizes(other._orbit_sizes),
+  _order(other._order),
+  _has_pcgs(other._has_pcgs),
+  _pcgs(other._pcgs),
+  _pcgs_relative_orders(other._pcgs_relative_orders),
+  _pcgs_powers(other._pcgs_powers),
+  _is_symmetric(other._is_symmetric),
+  _is_alternating(other._is_alternating)
+{}
+
+BSGS &BSGS::operator=(BSGS const &other)
 {
-  order_type res = 1;
+  BSGS tmp(other);
+  std::swap(*this, tmp);
 
-  for (unsigned i = 0u; i < base_size(); ++i)
-    res *= orbit(i).size();
-
-  return res;
+  return *this;
 }
 
 PermSet BSGS::strong_generators(unsigned i) const
 {
+  assert(i < _strong_generator_indices.size());
+
   PermSet ret;
-  for (Perm const &sg : strong_generators()) {
-    if (sg.stabilizes(_base.begin(), _base.begin() + i))
-      ret.insert(sg);
-  }
+  for (unsigned j : _strong_generator_indices[i])
+    ret.insert(_strong_generators[j]);
 
   return ret;
 }
@@ -185,6 +227,22 @@ PermSet BSGS::transversals(unsigned i) const
 PermSet BSGS::stabilizers(unsigned i) const
 { return schreier_structure(i)->labels(); }
 
+Perm BSGS::pcgs_element(std::vector<unsigned> const &exponents) const
+{
+  assert(_has_pcgs);
+  assert(exponents.size() == _pcgs.size());
+
+  Perm result(_degree);
+  for (unsigned i = 0u; i < _pcgs.size(); ++i) {
+    assert(exponents[i] < _pcgs_relative_orders[i]);
+
+    if (exponents[i] > 0u)
+      result *= _pcgs_powers[i][exponents[i]];
+  }
+
+  return result;
+}
+
 std::pair<Perm, unsigned> BSGS::strip(Perm const &perm, unsigned offs) const
 {
   Perm result(perm);
@@ -207,6 +265,135 @@ bool BSGS::strips_completely(Perm const &perm) const
   return strip_result.first.id() && strip_result.second == base_size() + 1u;
 }
 
+std::vector<bool> BSGS::strips_completely(std::vector<Perm> const &perms,
+                                           unsigned num_threads) const
+{
+  std::size_t n = perms.size();
+
+  // images of all (partially stripped) permutations, stored contiguously
+  std::vector<unsigned> images(n * _degree);
+
+  util::parallel_for(n, num_threads,
+    [&](std::size_t begin, std::size_t end, unsigned)
+    {
+      for (std::size_t k = begin; k < end; ++k) {
+        assert(perms[k].degree() == _degree);
+
+        for (unsigned x = 0u; x < _degree; ++x)
+          images[k * _degree + x] = perms[k][x];
+      }
+    });
+
+  std::vector<char> stripped(n, 1);
+  std::vector<unsigned> transversal_index(n);
+
+  for (unsigned i = 0u; i < base_size(); ++i) {
+    unsigned b = base_point(i);
+    auto ss(schreier_structure(i));
+
+    // inverse transversals of all orbit points encountered at this level
+    std::vector<int> transversal_table_index(_degree, -1);
+    std::vector<unsigned> transversal_table;
+
+    for (std::size_t k = 0u; k < n; ++k) {
+      if (!stripped[k])
+        continue;
+
+      unsigned beta = images[k * _degree + b];
+
+      if (beta == b) {
+        transversal_index[k] = _degree;
+        continue;
+      }
+
+      if (transversal_table_index[beta] == -1) {
+        if (!ss->contains(beta)) {
+          stripped[k] = 0;
+          continue;
+        }
+
+        transversal_table_index[beta] =
+          static_cast<int>(transversal_table.size() / _degree);
+
+        auto transv_inv((~ss->transversal(beta)).vect());
+        transversal_table.insert(transversal_table.end(),
+                                 transv_inv.begin(), transv_inv.end());
+      }
+
+      transversal_index[k] = transversal_table_index[beta];
+    }
+
+    util::parallel_for(n, num_threads,
+      [&](std::size_t begin, std::size_t end, unsigned)
+      {
+        for (std::size_t k = begin; k < end; ++k) {
+          if (!stripped[k] || transversal_index[k] == _degree)
+            continue;
+
+          unsigned const *transv_inv =
+            transversal_table.data() + transversal_index[k] * _degree;
+
+          unsigned *image = images.data() + k * _degree;
+
+          for (unsigned x = 0u; x < _degree; ++x)
+            image[x] = transv_inv[image[x]];
+        }
+      });
+  }
+
+  util::parallel_for(n, num_threads,
+    [&](std::size_t begin, std::size_t end, unsigned)
+    {
+      for (std::size_t k = begin; k < end; ++k) {
+        if (!stripped[k])
+          continue;
+
+        for (unsigned x = 0u; x < _degree; ++x) {
+          if (images[k * _degree + x] != x) {
+            stripped[k] = 0;
+            break;
+          }
+        }
+      }
+    });
+
+  return std::vector<bool>(stripped.begin(), stripped.end());
+}
+
+void BSGS::update_order()
+{
+  _order = 1;
+
+  for (unsigned i = 0u; i < base_size(); ++i)
+    _order *= orbit_size(i);
+}
+
+void BSGS::update_orbit_size(unsigned i)
+{
+  if (i >= _orbit_sizes.size())
+    _orbit_sizes.resize(i + 1u, 1u);
+
+  _orbit_sizes[i] = schreier_structure(i)->nodes().size();
+}
+
+void BSGS::update_strong_generator_indices()
+{
+  // a strong generator belongs to all levels up to (and including) the
+  // position of the first base point it does not stabilize
+  _strong_generator_indices.assign(base_size() + 1u, {});
+
+  for (unsigned j = 0u; j < _strong_generators.size(); ++j) {
+    Perm const &sg(_strong_generators[j]);
+
+    unsigned i_max = 0u;
+    while (i_max < base_size() && sg[base_point(i_max)] == base_point(i_max))
+      ++i_max;
+
+    for (unsigned i = 0u; i <= i_max; ++i)
+      _strong_generator_indices[i].push_back(j);
+  }
+}
+
 void BSGS::extend_base(unsigned bp)
 { _base.push_back(bp); }
 
@@ -224,6 +411,10 @@ void BSGS::transversals_init(BSGSOptions const *options)
       break;
     case BSGSOptions::Transversals::SHALLOW_SCHREIER_TREES:
       throw std::logic_error("TODO");
+    case BSGSOptions::Transversals::HYBRID:
+      _transversals = std::make_shared<BSGSHybridTransversals>(
+        options->hybrid_transversals_budget);
+      break;
   }
 }
 
@@ -87,19 +87,23 @@ void BSGS::swap_base_points(unsigned i)
   std::swap(_base[i], _base[i + 1u]);
   DBG(TRACE) << "New base: " << _base;
 
+  update_strong_generator_indices();
+
   // recompute schreier structures for base points i and i+1
   auto sgi(stabilizers(i));
-  auto oi(orbit(i));
+  auto oi_size(orbit_size(i));
 
   update_schreier_structure(i, sgi);
 
   auto sgi1(strong_generators(i + 1u));
-  auto oi1(orbit(i + 1u));
+  sgi1.insert_inverses();
+
+  auto oi1_size(orbit_size(i + 1u));
 
   update_schreier_structure(i + 1u, sgi1);
 
   // final size of the fundamental orbit O_(i+1)
-  auto oi1_desired_size = (oi.size() * oi1.size()) / orbit(i).size();
+  auto oi1_desired_size = (oi_size * oi1_size) / orbit_size(i);
 
   DBG(TRACE) << "Desired size of O(" << i + 1u << ") is " << oi1_desired_size;
 
@@ -107,7 +111,7 @@ void BSGS::swap_base_points(unsigned i)
   SchreierGeneratorQueue schreier_generator_queue;
 
   sgi = stabilizers(i);
-  oi = orbit(i);
+  auto oi(orbit(i));
 
   schreier_generator_queue.update(sgi, oi, schreier_structure(i));
 
@@ -119,23 +123,26 @@ void BSGS::swap_base_points(unsigned i)
 
       // extend strong generators
       sgi1.insert(perm);
+      sgi1.insert(~perm);
       update_schreier_structure(i + 1u, sgi1);
 
       DBG(TRACE) << "S(" << i + 1u << ") = " << stabilizers(i + 1u);
       DBG(TRACE) << "O(" << i + 1u << ") = " << orbit(i + 1u);
 
-      if (orbit(i + 1u).size() >= oi1_desired_size)
+      if (orbit_size(i + 1u) >= oi1_desired_size)
         break;
     }
   }
 
-  assert(orbit(i + 1u).size() >= oi1_desired_size);
+  assert(orbit_size(i + 1u) >= oi1_desired_size);
 
-  DBG(TRACE) << "Final size of O(" << i + 1u << ") is " << orbit(i + 1u).size();
+  DBG(TRACE) << "Final size of O(" << i + 1u << ") is " << orbit_size(i + 1u);
 
   // eliminate duplicate strong generators
   _strong_generators.insert(sgi1.begin(), sgi1.end());
   _strong_generators.make_unique();
+
+  update_strong_generator_indices();
 }
 
 void BSGS::transpose_base_point(unsigned i, unsigned j)
@@ -151,13 +158,15 @@ unsigned BSGS::insert_redundant_base_point(unsigned bp, unsigned i_min)
 {
   unsigned i = std::min(i_min + 1u, static_cast<unsigned>(base_size()));
 
-  while (i < base_size()) {
-    if (base_point(i) == bp)
-      return i;
+  auto it(std::find(_base.begin() + i, _base.end(), bp));
+  if (it != _base.end())
+    return static_cast<unsigned>(it - _base.begin());
 
+  // find the first position at which the pointwise base stabilizer fixes bp
+  while (i < base_size()) {
     bool stabilized = true;
 
-    for (Perm const &stab : stabilizers(i - 1u)) {
+    for (Perm const &stab : stabilizers(i)) {
        if (stab[bp] != bp) {
           stabilized = false;
           break;
@@ -170,20 +179,38 @@ unsigned BSGS::insert_redundant_base_point(unsigned bp, unsigned i_min)
     ++i;
   }
 
-  bool reuse_stabilizers = i < base_size();
+  // the group at the new level is the same as the one at the current level i
+  PermSet generators;
+
+  if (i < base_size()) {
+    generators = stabilizers(i);
+  } else {
+    generators = strong_generators(i);
+    generators.insert_inverses();
+  }
 
   // insert new base point
   extend_base(bp, i);
 
+  update_strong_generator_indices();
+
   // compute schreier structure for new base point
-  insert_schreier_structure(
-    i, reuse_stabilizers ? stabilizers(i - 1u) : strong_generators(i));
+  insert_schreier_structure(i, generators);
 
   return i;
 }
 
 void BSGS::conjugate(Perm const &conj)
 {
+  // conj is a group element, if it fixes the first i + 1 base points it
+  // normalizes the i-th pointwise stabilizer and fixes its base point, the
+  // fundamental orbit and transversals of that level thus remain valid
+  // (base changes which leave a prefix of the base unchanged thus only
+  // rebuild the levels after it)
+  unsigned i_min = 0u;
+  while (i_min < base_size() && conj[base_point(i_min)] == base_point(i_min))
+    ++i_min;
+
   // conjugate base
   for (unsigned &b : _base)
     b = conj[b];
@@ -193,8 +220,12 @@ void BSGS::conjugate(Perm const &conj)
     sg = ~conj * sg * conj;
 
   // update schreier structures
-  for (unsigned i = 0u; i < base_size(); ++i)
-    update_schreier_structure(i, strong_generators(i));
+  for (unsigned i = i_min; i < base_size(); ++i) {
+    auto generators(strong_generators(i));
+    generators.insert_inverses();
+
+    update_schreier_structure(i, generators);
+  }
 }
 
 } // namespace internal
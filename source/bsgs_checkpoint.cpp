@@ -0,0 +1,272 @@
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "bsgs.hpp"
+#include "dbg.hpp"
+#include "orbit.hpp"
+#include "perm.hpp"
+#include "perm_set.hpp"
+#include "schreier_generator_queue.hpp"
+#include "schreier_structure.hpp"
+
+namespace
+{
+
+using mpsym::internal::Perm;
+using mpsym::internal::PermSet;
+
+char const *CHECKPOINT_HEADER = "mpsym_schreier_sims_checkpoint";
+unsigned const CHECKPOINT_VERSION = 1u;
+
+void write_perm(std::ostream &os, Perm const &perm)
+{
+  for (unsigned x = 0u; x < perm.degree(); ++x)
+    os << (x == 0u ? "" : " ") << perm[x];
+
+  os << "\n";
+}
+
+void write_perm_set(std::ostream &os, PermSet const &perms)
+{
+  os << perms.size() << "\n";
+
+  for (Perm const &perm : perms)
+    write_perm(os, perm);
+}
+
+template<typename T>
+T read_value(std::istream &is)
+{
+  T val;
+  if (!(is >> val))
+    throw std::runtime_error("malformed schreier sims checkpoint");
+
+  return val;
+}
+
+Perm read_perm(std::istream &is, unsigned degree)
+{
+  std::vector<unsigned> perm(degree);
+  std::vector<bool> seen(degree, false);
+
+  for (unsigned x = 0u; x < degree; ++x) {
+    unsigned y = read_value<unsigned>(is);
+
+    if (y >= degree || seen[y])
+      throw std::runtime_error("malformed schreier sims checkpoint");
+
+    perm[x] = y;
+    seen[y] = true;
+  }
+
+  return Perm(perm);
+}
+
+PermSet read_perm_set(std::istream &is, unsigned degree)
+{
+  PermSet perms;
+
+  auto n = read_value<unsigned>(is);
+  for (unsigned i = 0u; i < n; ++i)
+    perms.insert(read_perm(is, degree));
+
+  return perms;
+}
+
+} // anonymous namespace
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+void BSGS::schreier_sims_checkpoint(
+  std::string const &file,
+  std::vector<PermSet> const &strong_generators,
+  std::vector<SchreierGeneratorQueue> const &schreier_generator_queues,
+  unsigned i) const
+{
+  DBG(DEBUG) << "Writing Schreier Sims checkpoint to " << file;
+
+  assert(strong_generators.size() == base_size());
+  assert(_schreier_sims_updates.size() == base_size());
+
+  // write to temporary file first so that a previous checkpoint is never lost
+  std::string file_tmp(file + ".tmp");
+
+  {
+    std::ofstream os(file_tmp);
+
+    os << CHECKPOINT_HEADER << " " << CHECKPOINT_VERSION << "\n";
+
+    os << _degree << "\n";
+
+    write_perm_set(os, _strong_generators);
+
+    os << base_size() << "\n";
+    for (unsigned j = 0u; j < base_size(); ++j)
+      os << (j == 0u ? "" : " ") << base_point(j);
+    os << "\n";
+
+    for (unsigned j = 0u; j < base_size(); ++j) {
+      auto const &updates(_schreier_sims_updates[j]);
+
+      os << updates.size() << "\n";
+      for (unsigned k = 0u; k < updates.size(); ++k)
+        os << (k == 0u ? "" : " ") << updates[k];
+      os << "\n";
+
+      write_perm_set(os, strong_generators[j]);
+    }
+
+    os << schreier_generator_queues.size() << "\n";
+    for (auto const &queue : schreier_generator_queues) {
+      auto pos(queue.position());
+
+      os << pos.valid << " "
+         << pos.used << " "
+         << pos.exhausted << " "
+         << pos.beta << " "
+         << pos.sg << "\n";
+    }
+
+    os << i << "\n";
+
+    if (!os)
+      throw std::runtime_error("failed to write schreier sims checkpoint");
+  }
+
+  if (std::rename(file_tmp.c_str(), file.c_str()) != 0)
+    throw std::runtime_error("failed to write schreier sims checkpoint");
+}
+
+bool BSGS::schreier_sims_resume(
+  std::string const &file,
+  PermSet const &generators,
+  std::vector<PermSet> &strong_generators,
+  std::vector<Orbit> &fundamental_orbits,
+  std::vector<SchreierGeneratorQueue> &schreier_generator_queues,
+  unsigned &i)
+{
+  std::ifstream is(file);
+  if (!is)
+    return false;
+
+  DBG(DEBUG) << "Resuming Schreier Sims from checkpoint " << file;
+
+  if (read_value<std::string>(is) != CHECKPOINT_HEADER ||
+      read_value<unsigned>(is) != CHECKPOINT_VERSION) {
+    throw std::runtime_error("malformed schreier sims checkpoint");
+  }
+
+  // make sure that the checkpoint belongs to the same generating set
+  if (read_value<unsigned>(is) != _degree)
+    throw std::runtime_error("schreier sims checkpoint does not match generators");
+
+  auto checkpoint_generators(read_perm_set(is, _degree));
+
+  PermSet generators_closed(generators);
+  generators_closed.insert_inverses();
+
+  std::unordered_set<Perm> generators_expected;
+  for (Perm const &gen : generators_closed) {
+    if (!gen.id())
+      generators_expected.insert(gen);
+  }
+
+  std::unordered_set<Perm> generators_actual(checkpoint_generators.begin(),
+                                             checkpoint_generators.end());
+
+  if (generators_actual != generators_expected)
+    throw std::runtime_error("schreier sims checkpoint does not match generators");
+
+  // restore base
+  _base.clear();
+  _transversals->clear();
+  _orbit_sizes.clear();
+  _schreier_sims_updates.clear();
+  _strong_generators = checkpoint_generators;
+
+  strong_generators.clear();
+  fundamental_orbits.clear();
+
+  auto base_size_ = read_value<unsigned>(is);
+  for (unsigned j = 0u; j < base_size_; ++j) {
+    auto bp = read_value<unsigned>(is);
+    if (bp >= _degree)
+      throw std::runtime_error("malformed schreier sims checkpoint");
+
+    extend_base(bp);
+  }
+
+  // replay strong generator updates, this reproduces the fundamental orbits
+  // and schreier structures exactly
+  for (unsigned j = 0u; j < base_size(); ++j) {
+    std::vector<unsigned> updates(read_value<unsigned>(is));
+    for (auto &update : updates)
+      update = read_value<unsigned>(is);
+
+    auto level_generators(read_perm_set(is, _degree));
+
+    unsigned offs = 0u;
+    for (unsigned update : updates) {
+      if (offs + update > level_generators.size())
+        throw std::runtime_error("malformed schreier sims checkpoint");
+
+      schreier_sims_update_strong_gens(j,
+                                       level_generators.subset(offs, update),
+                                       strong_generators,
+                                       fundamental_orbits);
+      offs += update;
+    }
+
+    if (offs != level_generators.size())
+      throw std::runtime_error("malformed schreier sims checkpoint");
+  }
+
+  // restore schreier generator queue positions
+  auto num_queues = read_value<unsigned>(is);
+  if (num_queues != base_size())
+    throw std::runtime_error("malformed schreier sims checkpoint");
+
+  schreier_generator_queues.resize(num_queues);
+
+  for (unsigned j = 0u; j < num_queues; ++j) {
+    SchreierGeneratorQueue::Position pos;
+    pos.valid = read_value<bool>(is);
+    pos.used = read_value<bool>(is);
+    pos.exhausted = read_value<bool>(is);
+    pos.beta = read_value<unsigned>(is);
+    pos.sg = read_value<unsigned>(is);
+
+    if (pos.valid && !pos.exhausted &&
+        (pos.beta >= fundamental_orbits[j].size() ||
+         pos.sg >= strong_generators[j].size())) {
+      throw std::runtime_error("malformed schreier sims checkpoint");
+    }
+
+    schreier_generator_queues[j].restore(strong_generators[j],
+                                         fundamental_orbits[j],
+                                         schreier_structure(j),
+                                         pos);
+  }
+
+  i = read_value<unsigned>(is);
+  if (i > base_size())
+    throw std::runtime_error("malformed schreier sims checkpoint");
+
+  DBG(DEBUG) << "Resumed with B = " << _base;
+
+  return true;
+}
+
+} // namespace internal
+
+} // namespace mpsym
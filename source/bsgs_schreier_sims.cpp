@@ -1,6 +1,9 @@
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cstdio>
 #include <memory>
+#include <string>
 #include <tuple>
 #include <vector>
 
@@ -33,30 +36,92 @@ void BSGS::schreier_sims(PermSet const &generators,
   // initialize
   std::vector<PermSet> strong_generators;
   std::vector<Orbit> fundamental_orbits;
+  std::vector<SchreierGeneratorQueue> schreier_generator_queues;
+  unsigned i;
 
-  schreier_sims_init(generators, strong_generators, fundamental_orbits);
+  auto const &checkpoint_file(options->schreier_sims_checkpoint_file);
+
+  bool resumed = !checkpoint_file.empty() &&
+                 options->schreier_sims_checkpoint_resume &&
+                 schreier_sims_resume(checkpoint_file,
+                                      generators,
+                                      strong_generators,
+                                      fundamental_orbits,
+                                      schreier_generator_queues,
+                                      i);
+
+  if (!resumed) {
+    schreier_sims_init(generators, strong_generators, fundamental_orbits);
+
+    schreier_generator_queues.resize(base_size());
+    i = base_size();
+  }
 
   // run algorithm
-  schreier_sims(strong_generators, fundamental_orbits, options, aborted);
+  schreier_sims(strong_generators,
+                fundamental_orbits,
+                schreier_generator_queues,
+                i,
+                options,
+                aborted);
 }
 
 void BSGS::schreier_sims(std::vector<PermSet> &strong_generators,
                          std::vector<Orbit> &fundamental_orbits,
-                         BSGSOptions const *,
+                         BSGSOptions const *options,
                          timeout::flag aborted)
 {
   std::vector<SchreierGeneratorQueue> schreier_generator_queues(base_size());
 
+  schreier_sims(strong_generators,
+                fundamental_orbits,
+                schreier_generator_queues,
+                base_size(),
+                options,
+                aborted);
+}
+
+void BSGS::schreier_sims(std::vector<PermSet> &strong_generators,
+                         std::vector<Orbit> &fundamental_orbits,
+                         std::vector<SchreierGeneratorQueue> &schreier_generator_queues,
+                         unsigned i,
+                         BSGSOptions const *options,
+                         timeout::flag aborted)
+{
+  using clock = std::chrono::steady_clock;
+
+  auto const &checkpoint_file(options->schreier_sims_checkpoint_file);
+  auto checkpoint_interval(std::chrono::duration<double>(
+    options->schreier_sims_checkpoint_interval));
+
+  auto last_checkpoint(clock::now());
+
   DBG(TRACE) << "Iterating over Schreier Generators";
 
   // main loop
-  unsigned i = base_size();
   while (i >= 1u) {
-    if (timeout::is_set(aborted))
-      throw timeout::AbortedError("schreier_sims");
-
     DBG(TRACE) << "i = " << i;
 top:
+    if (timeout::is_set(aborted)) {
+      if (!checkpoint_file.empty()) {
+        schreier_sims_checkpoint(
+          checkpoint_file, strong_generators, schreier_generator_queues, i);
+      }
+
+      throw timeout::AbortedError("schreier_sims");
+    }
+
+    if (!checkpoint_file.empty() && checkpoint_interval.count() > 0.0) {
+      auto now(clock::now());
+
+      if (now - last_checkpoint >= checkpoint_interval) {
+        schreier_sims_checkpoint(
+          checkpoint_file, strong_generators, schreier_generator_queues, i);
+
+        last_checkpoint = now;
+      }
+    }
+
     schreier_generator_queues[i - 1].update(strong_generators[i - 1],
                                             fundamental_orbits[i - 1],
                                             schreier_structure(i - 1));
@@ -135,6 +200,9 @@ top:
     --i;
   }
 
+  if (!checkpoint_file.empty())
+    std::remove(checkpoint_file.c_str());
+
   schreier_sims_finish();
 }
 
@@ -159,8 +227,10 @@ void BSGS::schreier_sims_random(PermSet const &generators,
       schreier_sims_random(strong_generators, fundamental_orbits, options, aborted);
 
       // we assume that if the BSGS is correct if it has the correct order
-      if (check_order)
+      if (check_order) {
+         update_order();
          return order() == options->schreier_sims_random_known_order;
+      }
 
       return false;
     };
@@ -268,6 +338,8 @@ void BSGS::schreier_sims_init(PermSet const &generators,
 {
   _base.clear();
   _transversals->clear();
+  _orbit_sizes.clear();
+  _schreier_sims_updates.clear();
   _strong_generators = generators;
   _strong_generators.insert_inverses();
 
@@ -340,18 +412,25 @@ void BSGS::schreier_sims_update_strong_gens(
     }
 
     strong_generators.resize(i + 1u);
+    _schreier_sims_updates.resize(i + 1u);
   }
 
   fundamental_orbits[i].update(strong_generators[i],
                                new_strong_generators,
                                schreier_structure(i));
 
+  _orbit_sizes[i] = fundamental_orbits[i].size();
+
   strong_generators[i].insert(new_strong_generators.begin(),
                               new_strong_generators.end());
+
+  _schreier_sims_updates[i].push_back(new_strong_generators.size());
 }
 
 void BSGS::schreier_sims_finish()
 {
+  _schreier_sims_updates.clear();
+
   _strong_generators.clear();
 
   for (unsigned i = 0u; i < base_size(); ++i) {
@@ -1,3 +1,4 @@
+#include <cassert>
 #include <cmath>
 #include <memory>
 #include <stdexcept>
@@ -57,6 +58,8 @@ void BSGS::solve(PermSet const &generators)
   }
 
   DBG(DEBUG) << "=> Success";
+
+  solve_finish();
 }
 
 bool BSGS::solve_s_normal_closure(PermSet const &generators,
@@ -89,6 +92,10 @@ bool BSGS::solve_s_normal_closure(PermSet const &generators,
           conjugates.first = g;
           conjugates.second = h;
 
+          // generators adjoined so far do not necessarily normalize the
+          // original group, start over from it
+          *this = original_bsgs;
+
           return false;
         }
 #ifndef NDEBUG
@@ -128,31 +135,33 @@ void BSGS::solve_adjoin_normalizing_generator(Perm const &gen)
   DBG(TRACE) << "Begin adjoining normalizing generator";
   DBG(TRACE) << "Generator is: " << gen;
 
+  std::vector<Perm> pcgs;
+  std::vector<unsigned> pcgs_relative_orders;
+
   unsigned i = 0u;
   Perm h(gen);
 
   while (!h.id()) {
-    ++i;
-    DBG(TRACE) << "Iteration " << i;
+    DBG(TRACE) << "Iteration " << i + 1u;
 
-    if (i > base_size()) {
-      for (unsigned j = 1u; j <= degree(); ++j) {
+    if (i == base_size()) {
+      for (unsigned j = 0u; j < degree(); ++j) {
         if (h[j] != j) {
-          extend_base(i);
+          extend_base(j);
           break;
         }
       }
 
+      reserve_schreier_structure(i);
+
       DBG(TRACE) << ">>> Updated base: " << _base << " <<<";
     }
 
-    unsigned base_elem = base_point(i - 1u);
-
-    throw std::logic_error("TODO: schreier structure initialization");
+    unsigned base_elem = base_point(i);
 
     DBG(TRACE)
-      << "Considering h = " << h << " and b_" << i << " = " << base_elem
-      << " (with orbit " << schreier_structure(i - 1u)->nodes() << ")";
+      << "Considering h = " << h << " and b_" << i + 1u << " = " << base_elem
+      << " (with orbit " << schreier_structure(i)->nodes() << ")";
 
     unsigned m = 1u;
     Perm h_m(h);
@@ -160,7 +169,7 @@ void BSGS::solve_adjoin_normalizing_generator(Perm const &gen)
 
     DBG(TRACE) << "h^1 = " << h_m;
 
-    while (!schreier_structure(i - 1u)->contains(tmp)) {
+    while (!schreier_structure(i)->contains(tmp)) {
       ++m;
       h_m *= h;
       tmp = h_m[base_elem];
@@ -168,15 +177,16 @@ void BSGS::solve_adjoin_normalizing_generator(Perm const &gen)
       DBG(TRACE) << "h^" << m << " = " << h_m;
     }
 
-    Perm u(schreier_structure(i - 1u)->transversal(tmp));
+    Perm u(schreier_structure(i)->transversal(tmp));
     DBG(TRACE) << "u = " << u;
 
     if (m > 1u) {
       DBG(TRACE) << "Enlarging:";
 
-      for (unsigned j = 0u; j < i; ++j) { // TODO: avoid complete recomputation
+      for (unsigned j = 0u; j <= i; ++j) { // TODO: avoid complete recomputation
         PermSet s_j(schreier_structure(j)->labels());
         s_j.insert(h);
+        s_j.insert(~h);
 
         update_schreier_structure(j, s_j);
 
@@ -186,14 +196,44 @@ void BSGS::solve_adjoin_normalizing_generator(Perm const &gen)
 
       _strong_generators.insert(h);
       DBG(TRACE) << "  >>> Updated SGS: " << _strong_generators << " <<<";
+
+      pcgs.push_back(h);
+      pcgs_relative_orders.push_back(m);
     }
 
     h = h_m * ~u;
+    ++i;
   }
 
+  // the generators adjoined here precede those of the normalized group in the
+  // polycyclic generating sequence
+  _pcgs.insert(_pcgs.begin(), pcgs.begin(), pcgs.end());
+  _pcgs_relative_orders.insert(_pcgs_relative_orders.begin(),
+                               pcgs_relative_orders.begin(),
+                               pcgs_relative_orders.end());
+
   DBG(TRACE) << "Finished adjoining normalizing generator";
 }
 
+void BSGS::solve_finish()
+{
+  _pcgs_powers.clear();
+
+  for (unsigned i = 0u; i < _pcgs.size(); ++i) {
+    std::vector<Perm> powers {Perm(degree())};
+
+    for (unsigned e = 1u; e < _pcgs_relative_orders[i]; ++e)
+      powers.push_back(powers.back() * _pcgs[i]);
+
+    _pcgs_powers.push_back(powers);
+  }
+
+  _has_pcgs = true;
+
+  DBG(DEBUG) << "=> PCGS = " << pcgs();
+  DBG(DEBUG) << "=> Relative orders = " << _pcgs_relative_orders;
+}
+
 } // namespace internal
 
 } // namespace mpsym
@@ -0,0 +1,377 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ELEMENT_TABLE_AVX2
+#include <immintrin.h>
+#endif
+
+#include "dbg.hpp"
+#include "element_table.hpp"
+#include "parallel.hpp"
+#include "perm.hpp"
+#include "perm_group.hpp"
+#include "task_mapping.hpp"
+#include "timeout.hpp"
+
+namespace
+{
+
+// gathers always load four bytes, even if images are narrower
+std::size_t const GATHER_PADDING = 4u;
+
+// number of elements scanned between checks for timeouts
+std::size_t const SCAN_CHUNK_SIZE = 4096u;
+
+#ifdef ELEMENT_TABLE_AVX2
+// compares the images of tasks under eight consecutive elements at once, the
+// images at every task position are gathered from the eight rows and compared
+// against the representative until all eight images have become either
+// smaller or larger, only whole groups of eight elements are processed and
+// the index of the first smaller image (or of the first unprocessed element)
+// is returned
+template<typename T>
+__attribute__((target("avx2")))
+std::size_t find_smaller_avx2(T const *elements,
+                              unsigned degree,
+                              mpsym::TaskMapping const &tasks,
+                              unsigned offset,
+                              mpsym::TaskMapping const &representative,
+                              std::size_t begin,
+                              std::size_t end)
+{
+  int const *base = reinterpret_cast<int const *>(elements);
+
+  __m256i const rows = _mm256_mullo_epi32(
+    _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+    _mm256_set1_epi32(static_cast<int>(degree)));
+
+  __m256i const image_mask = _mm256_set1_epi32(
+    static_cast<int>(std::numeric_limits<T>::max()));
+
+  __m256i const offsets = _mm256_set1_epi32(static_cast<int>(offset));
+
+  std::size_t i = begin;
+
+  for (; i + 8u <= end; i += 8u) {
+    __m256i equal = _mm256_set1_epi32(-1);
+    __m256i less = _mm256_setzero_si256();
+
+    for (unsigned j = 0u; j < tasks.size(); ++j) {
+      unsigned task = tasks[j];
+
+      __m256i images;
+
+      if (task >= offset && task < offset + degree) {
+        __m256i indices = _mm256_add_epi32(
+          _mm256_set1_epi32(static_cast<int>(i * degree + task - offset)),
+          rows);
+
+        images = _mm256_i32gather_epi32(base, indices, sizeof(T));
+        images = _mm256_and_si256(images, image_mask);
+        images = _mm256_add_epi32(images, offsets);
+      } else {
+        images = _mm256_set1_epi32(static_cast<int>(task));
+      }
+
+      __m256i current = _mm256_set1_epi32(
+        static_cast<int>(representative[j]));
+
+      less = _mm256_or_si256(
+        less, _mm256_and_si256(equal, _mm256_cmpgt_epi32(current, images)));
+
+      equal = _mm256_and_si256(equal, _mm256_cmpeq_epi32(images, current));
+
+      if (_mm256_testz_si256(equal, equal))
+        break;
+    }
+
+    int mask = _mm256_movemask_ps(_mm256_castsi256_ps(less));
+    if (mask != 0)
+      return i + static_cast<std::size_t>(__builtin_ctz(mask));
+  }
+
+  return i;
+}
+#endif
+
+} // anonymous namespace
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+ElementTable::ElementTable(PermGroup const &group,
+                           unsigned num_threads,
+                           std::uint64_t max_order,
+                           timeout::flag aborted)
+: _degree(group.degree()),
+  _simd(simd_available())
+{
+  if (group.order() > max_order)
+    throw std::invalid_argument("group too large for element table");
+
+  if (_degree > 1u << 16)
+    throw std::invalid_argument("degree too large for element table");
+
+  _width = _degree <= 1u << 8 ? 1u : 2u;
+  _size = static_cast<std::size_t>(group.order());
+
+  DBG(DEBUG) << "Building element table of size " << _size;
+
+  _elements.resize(_size * _degree * _width + GATHER_PADDING);
+
+  if (_width == 1u) {
+    build<std::uint8_t>(group, num_threads, aborted);
+    sort<std::uint8_t>();
+  } else {
+    build<std::uint16_t>(group, num_threads, aborted);
+    sort<std::uint16_t>();
+  }
+}
+
+Perm ElementTable::element(std::size_t i) const
+{
+  std::vector<unsigned> perm(_degree);
+
+  if (_width == 1u)
+    std::copy(row<std::uint8_t>(i), row<std::uint8_t>(i + 1u), perm.begin());
+  else
+    std::copy(row<std::uint16_t>(i), row<std::uint16_t>(i + 1u), perm.begin());
+
+  return Perm(perm);
+}
+
+bool ElementTable::contains(Perm const &perm) const
+{
+  if (perm.degree() != _degree)
+    return false;
+
+  return _width == 1u ? contains_<std::uint8_t>(perm)
+                      : contains_<std::uint16_t>(perm);
+}
+
+bool ElementTable::simd_available()
+{
+#ifdef ELEMENT_TABLE_AVX2
+  static bool const available = __builtin_cpu_supports("avx2");
+  return available;
+#else
+  return false;
+#endif
+}
+
+TaskMapping ElementTable::permuted(std::size_t i,
+                                   TaskMapping const &tasks,
+                                   unsigned offset) const
+{
+  std::vector<unsigned> res(tasks.size());
+
+  for (unsigned j = 0u; j < tasks.size(); ++j) {
+    unsigned task = tasks[j];
+
+    if (task >= offset && task < offset + _degree) {
+      task = (_width == 1u ? row<std::uint8_t>(i)[task - offset]
+                           : row<std::uint16_t>(i)[task - offset]) + offset;
+    }
+
+    res[j] = task;
+  }
+
+  return TaskMapping(res);
+}
+
+std::size_t ElementTable::find_smaller(TaskMapping const &tasks,
+                                       unsigned offset,
+                                       TaskMapping const &representative,
+                                       std::size_t begin,
+                                       timeout::flag aborted) const
+{
+#ifdef ELEMENT_TABLE_AVX2
+  // gather indices are 32 bit
+  bool simd = _simd &&
+    _size * _degree <= static_cast<std::size_t>(
+                         std::numeric_limits<std::int32_t>::max());
+#endif
+
+  for (std::size_t i = begin; i < _size; i += SCAN_CHUNK_SIZE) {
+    if (timeout::is_set(aborted))
+      throw timeout::AbortedError("element table scan");
+
+    std::size_t end = std::min(i + SCAN_CHUNK_SIZE, _size);
+
+    // the scalar scan either finishes the remainder the vectorized scan left
+    // over or immediately confirms the smaller image it found
+    std::size_t i_scalar = i;
+
+#ifdef ELEMENT_TABLE_AVX2
+    if (simd) {
+      i_scalar = _width == 1u
+        ? find_smaller_avx2(row<std::uint8_t>(0u),
+                            _degree, tasks, offset, representative, i, end)
+        : find_smaller_avx2(row<std::uint16_t>(0u),
+                            _degree, tasks, offset, representative, i, end);
+    }
+#endif
+
+    std::size_t found = _width == 1u
+      ? find_smaller_scalar<std::uint8_t>(
+          tasks, offset, representative, i_scalar, end)
+      : find_smaller_scalar<std::uint16_t>(
+          tasks, offset, representative, i_scalar, end);
+
+    if (found != end)
+      return found;
+  }
+
+  return _size;
+}
+
+template<typename T>
+std::size_t ElementTable::find_smaller_scalar(
+  TaskMapping const &tasks,
+  unsigned offset,
+  TaskMapping const &representative,
+  std::size_t begin,
+  std::size_t end) const
+{
+  for (std::size_t i = begin; i < end; ++i) {
+    T const *r = row<T>(i);
+
+    for (unsigned j = 0u; j < tasks.size(); ++j) {
+      unsigned task = tasks[j];
+      if (task >= offset && task < offset + _degree)
+        task = r[task - offset] + offset;
+
+      if (task < representative[j])
+        return i;
+
+      if (task > representative[j])
+        break;
+    }
+  }
+
+  return end;
+}
+
+template<typename T>
+void ElementTable::build(PermGroup const &group,
+                         unsigned num_threads,
+                         timeout::flag aborted)
+{
+  // the same factorization PermGroup::const_iterator uses, every element maps
+  // x to f_0(f_1(...(x))) where f_i is taken from level i
+  std::vector<std::vector<Perm>> levels;
+
+  if (group.is_trivial()) {
+    levels.push_back({Perm(_degree)});
+
+  } else if (group.has_pcgs()) {
+    for (unsigned i = 0u; i < group.bsgs().pcgs_relative_orders().size(); ++i)
+      levels.push_back(group.bsgs().pcgs_powers(i));
+
+  } else {
+    for (unsigned i = 0u; i < group.bsgs().base_size(); ++i) {
+      auto transversals(group.bsgs().transversals(i));
+      levels.emplace_back(transversals.begin(), transversals.end());
+    }
+  }
+
+  // elements differing only in their first factor form a block which shares
+  // the product of all other factors
+  std::size_t block_size = levels[0].size();
+
+  util::parallel_for(
+    _size / block_size,
+    num_threads,
+    [&](std::size_t begin, std::size_t end, unsigned)
+    {
+      std::vector<unsigned> rest(_degree);
+
+      for (std::size_t b = begin; b < end; ++b) {
+        if (timeout::is_set(aborted))
+          throw timeout::AbortedError("element table");
+
+        std::iota(rest.begin(), rest.end(), 0u);
+
+        std::size_t state = b;
+        std::vector<Perm const *> factors;
+
+        for (unsigned i = 1u; i < levels.size(); ++i) {
+          factors.push_back(&levels[i][state % levels[i].size()]);
+          state /= levels[i].size();
+        }
+
+        for (auto it = factors.rbegin(); it != factors.rend(); ++it) {
+          for (unsigned x = 0u; x < _degree; ++x)
+            rest[x] = (**it)[rest[x]];
+        }
+
+        for (std::size_t i = 0u; i < block_size; ++i) {
+          Perm const &first = levels[0][i];
+
+          T *r = row<T>(b * block_size + i);
+          for (unsigned x = 0u; x < _degree; ++x)
+            r[x] = static_cast<T>(first[rest[x]]);
+        }
+      }
+    });
+}
+
+template<typename T>
+void ElementTable::sort()
+{
+  auto row_less = [&](std::size_t lhs, std::size_t rhs)
+  {
+    return std::lexicographical_compare(row<T>(lhs), row<T>(lhs + 1u),
+                                        row<T>(rhs), row<T>(rhs + 1u));
+  };
+
+  std::vector<std::size_t> order(_size);
+  std::iota(order.begin(), order.end(), 0u);
+  std::sort(order.begin(), order.end(), row_less);
+
+  std::vector<unsigned char> sorted(_elements.size());
+
+  std::size_t row_bytes = _degree * _width;
+  for (std::size_t i = 0u; i < _size; ++i) {
+    std::copy(_elements.begin() + order[i] * row_bytes,
+              _elements.begin() + (order[i] + 1u) * row_bytes,
+              sorted.begin() + i * row_bytes);
+  }
+
+  _elements.swap(sorted);
+}
+
+template<typename T>
+bool ElementTable::contains_(Perm const &perm) const
+{
+  std::vector<T> images(_degree);
+  for (unsigned x = 0u; x < _degree; ++x)
+    images[x] = static_cast<T>(perm[x]);
+
+  std::size_t lo = 0u, hi = _size;
+  while (lo < hi) {
+    std::size_t mid = lo + (hi - lo) / 2u;
+
+    if (std::lexicographical_compare(row<T>(mid), row<T>(mid + 1u),
+                                     images.begin(), images.end())) {
+      lo = mid + 1u;
+    } else {
+      hi = mid;
+    }
+  }
+
+  return lo < _size && std::equal(images.begin(), images.end(), row<T>(lo));
+}
+
+} // namespace internal
+
+} // namespace mpsym
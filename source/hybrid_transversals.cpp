@@ -0,0 +1,226 @@
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "dbg.hpp"
+#include "hybrid_transversals.hpp"
+#include "perm.hpp"
+#include "perm_set.hpp"
+
+namespace
+{
+
+// a level is considered hot once it has been accessed at least
+// (orbit size / EXPLICIT_ACCESS_RATIO) times, small levels thus
+// become explicit almost immediately
+unsigned const EXPLICIT_ACCESS_RATIO = 4u;
+
+} // anonymous namespace
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+std::size_t HybridTransversalsBudget::bytes_used() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  return _reserved + _cached;
+}
+
+bool HybridTransversalsBudget::reserve(std::size_t bytes)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  if (_reserved + bytes > _budget)
+    return false;
+
+  _reserved += bytes;
+
+  if (_reserved + _cached > _budget)
+    cache_evict(_reserved + _cached - _budget);
+
+  return true;
+}
+
+void HybridTransversalsBudget::release(std::size_t bytes)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  assert(bytes <= _reserved);
+  _reserved -= bytes;
+}
+
+bool HybridTransversalsBudget::cache_lookup(std::uint64_t id,
+                                            unsigned origin,
+                                            Perm &perm)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  auto it(_lru_index.find(key_type(id, origin)));
+  if (it == _lru_index.end())
+    return false;
+
+  _lru.splice(_lru.begin(), _lru, it->second);
+
+  perm = it->second->second;
+
+  return true;
+}
+
+void HybridTransversalsBudget::cache_insert(std::uint64_t id,
+                                            unsigned origin,
+                                            Perm const &perm)
+{
+  std::size_t bytes = perm_bytes(perm.degree());
+
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  if (_reserved + bytes > _budget)
+    return;
+
+  key_type key(id, origin);
+
+  if (_lru_index.find(key) != _lru_index.end())
+    return;
+
+  if (_reserved + _cached + bytes > _budget)
+    cache_evict(_reserved + _cached + bytes - _budget);
+
+  _lru.emplace_front(key, perm);
+  _lru_index[key] = _lru.begin();
+
+  _cached += bytes;
+}
+
+void HybridTransversalsBudget::cache_evict(std::size_t bytes)
+{
+  std::size_t evicted = 0u;
+
+  while (evicted < bytes && !_lru.empty()) {
+    auto const &entry(_lru.back());
+
+    std::size_t entry_bytes = perm_bytes(entry.second.degree());
+
+    _lru_index.erase(entry.first);
+    _lru.pop_back();
+
+    _cached -= entry_bytes;
+    evicted += entry_bytes;
+  }
+}
+
+void HybridTransversals::add_label(Perm const &label)
+{ _tree.add_label(label); }
+
+void HybridTransversals::create_edge(
+  unsigned origin, unsigned destination, unsigned label)
+{
+  if (!_tree.contains(origin))
+    ++_orbit_size;
+
+  _tree.create_edge(origin, destination, label);
+
+  // previously materialized coset representatives may now be stale
+  drop_explicit();
+  _id = _budget->make_id();
+  _accesses = 0u;
+  _explicit_retry = 0u;
+}
+
+unsigned HybridTransversals::root() const
+{ return _tree.root(); }
+
+std::vector<unsigned> HybridTransversals::nodes() const
+{ return _tree.nodes(); }
+
+PermSet HybridTransversals::labels() const
+{ return _tree.labels(); }
+
+bool HybridTransversals::contains(unsigned node) const
+{ return _tree.contains(node); }
+
+bool HybridTransversals::incoming(unsigned node, Perm const &edge) const
+{ return _tree.incoming(node, edge); }
+
+Perm HybridTransversals::transversal(unsigned origin) const
+{
+  if (is_explicit())
+    return _explicit_table[origin];
+
+  unsigned accesses = ++_accesses;
+  if (accesses * EXPLICIT_ACCESS_RATIO >= _orbit_size &&
+      accesses >= _explicit_retry.load(std::memory_order_relaxed) &&
+      make_explicit(accesses)) {
+    return _explicit_table[origin];
+  }
+
+  Perm result;
+  if (_budget->cache_lookup(_id, origin, result))
+    return result;
+
+  result = _tree.transversal(origin);
+  _budget->cache_insert(_id, origin, result);
+
+  return result;
+}
+
+void HybridTransversals::dump(std::ostream &os) const
+{
+  os << "hybrid transversals ("
+     << (is_explicit() ? "explicit" : "schreier tree")
+     << "): " << _tree;
+}
+
+bool HybridTransversals::make_explicit(unsigned accesses) const
+{
+  std::lock_guard<std::mutex> lock(_explicit_mutex);
+
+  if (is_explicit())
+    return true;
+
+  std::size_t bytes = _degree * HybridTransversalsBudget::perm_bytes(1u)
+                      + _orbit_size * _degree * sizeof(unsigned);
+
+  if (!_budget->reserve(bytes)) {
+    // back off exponentially so that the locks are not taken on every access
+    // while the budget stays exhausted
+    _explicit_retry.store(2u * accesses, std::memory_order_relaxed);
+    return false;
+  }
+
+  DBG(TRACE) << "Materializing transversals of orbit of size " << _orbit_size;
+
+  _explicit_bytes = bytes;
+  _explicit_table.assign(_degree, Perm(1u));
+
+  for (unsigned x : _tree.nodes())
+    _explicit_table[x] = _tree.transversal(x);
+
+  _explicit.store(true, std::memory_order_release);
+
+  return true;
+}
+
+void HybridTransversals::drop_explicit()
+{
+  if (!is_explicit())
+    return;
+
+  _explicit.store(false, std::memory_order_release);
+  _explicit_table.clear();
+
+  _budget->release(_explicit_bytes);
+  _explicit_bytes = 0u;
+}
+
+} // namespace internal
+
+} // namespace mpsym
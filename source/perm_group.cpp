@@ -4,11 +4,14 @@
 #include <memory>
 #include <ostream>
 #include <random>
+#include <set>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 #include <boost/multiprecision/cpp_int.hpp>
 
+#include "block_system.hpp"
 #include "bsgs.hpp"
 #include "orbit.hpp"
 #include "perm.hpp"
@@ -16,6 +19,301 @@
 #include "perm_set.hpp"
 #include "util.hpp"
 
+namespace
+{
+
+using mpsym::internal::BlockSystem;
+using mpsym::internal::BSGS;
+using mpsym::internal::Orbit;
+using mpsym::internal::Perm;
+using mpsym::internal::PermGroup;
+using mpsym::internal::PermSet;
+
+namespace timeout = mpsym::internal::timeout;
+
+std::vector<BSGS::order_type> fixed_points_symmetric(unsigned degree)
+{
+  // rencontres numbers, i.e. binom(degree, i) * derangements(degree - i)
+  std::vector<BSGS::order_type> derangements(degree + 1u);
+  derangements[0] = 1;
+
+  for (unsigned i = 2u; i <= degree; ++i)
+    derangements[i] = (i - 1u) * (derangements[i - 1u] + derangements[i - 2u]);
+
+  std::vector<BSGS::order_type> dist(degree + 1u);
+
+  BSGS::order_type binom = 1;
+  for (unsigned i = 0u; i <= degree; ++i) {
+    dist[i] = binom * derangements[degree - i];
+    binom = binom * (degree - i) / (i + 1u);
+  }
+
+  return dist;
+}
+
+// groups without a known structure are only enumerated up to this order
+BSGS::order_type const FIXED_POINTS_MAX_ENUMERATED_ORDER = 10000000;
+
+std::vector<BSGS::order_type> fixed_points_enumerate(
+  PermGroup const &group,
+  std::vector<unsigned> const &support,
+  timeout::flag aborted)
+{
+  if (group.order() > FIXED_POINTS_MAX_ENUMERATED_ORDER) {
+    throw std::runtime_error(
+      "can not determine fixed point distribution of group of order " +
+      group.order().str() + " which is neither symmetric nor a direct or "
+      "wreath product and too large to be enumerated");
+  }
+
+  std::vector<BSGS::order_type> dist(support.size() + 1u);
+
+  for (Perm const &perm : group) {
+    if (timeout::is_set(aborted))
+      throw timeout::AbortedError("fixed_points_distribution");
+
+    unsigned fixed = 0u;
+    for (unsigned x : support) {
+      if (perm[x] == x)
+        ++fixed;
+    }
+
+    ++dist[fixed];
+  }
+
+  return dist;
+}
+
+std::vector<BSGS::order_type> fixed_points_combine(
+  std::vector<BSGS::order_type> const &lhs,
+  std::vector<BSGS::order_type> const &rhs)
+{
+  std::vector<BSGS::order_type> dist(lhs.size() + rhs.size() - 1u);
+
+  for (unsigned i = 0u; i < lhs.size(); ++i) {
+    if (lhs[i] == 0)
+      continue;
+
+    for (unsigned j = 0u; j < rhs.size(); ++j)
+      dist[i + j] += lhs[i] * rhs[j];
+  }
+
+  return dist;
+}
+
+// distribution over n points from that over the points moved by a group
+std::vector<BSGS::order_type> fixed_points_pad(
+  std::vector<BSGS::order_type> const &dist,
+  unsigned n)
+{
+  std::vector<BSGS::order_type> padded(n + 1u - dist.size(), 0);
+  padded.insert(padded.end(), dist.begin(), dist.end());
+
+  return padded;
+}
+
+template<typename IT>
+PermGroup fixed_points_restricted_group(unsigned degree,
+                                        PermSet const &generators,
+                                        IT first,
+                                        IT last)
+{
+  PermSet restricted_generators;
+
+  for (Perm const &gen : generators) {
+    Perm restricted(gen.restricted(first, last));
+
+    if (!restricted.id())
+      restricted_generators.insert(restricted);
+  }
+
+  if (restricted_generators.empty())
+    return PermGroup(degree);
+
+  return PermGroup(degree, restricted_generators);
+}
+
+std::vector<BSGS::order_type> fixed_points_moved(PermGroup const &group,
+                                                 timeout::flag aborted);
+
+// an (intransitive) group which is the direct product of its restrictions to
+// its orbits fixes the sum of the points fixed by its components
+bool fixed_points_direct_product(PermGroup const &group,
+                                 std::vector<unsigned> const &support,
+                                 std::vector<BSGS::order_type> &dist,
+                                 timeout::flag aborted)
+{
+  auto generators(group.generators());
+  auto generators_with_inverses(generators.with_inverses());
+
+  std::vector<int> in_orbit(group.degree(), 0);
+  std::vector<PermGroup> restrictions;
+  BSGS::order_type order = 1;
+
+  for (unsigned x : support) {
+    if (in_orbit[x])
+      continue;
+
+    auto orbit(Orbit::generate(x, generators_with_inverses));
+
+    for (unsigned y : orbit)
+      in_orbit[y] = 1;
+
+    restrictions.push_back(fixed_points_restricted_group(
+      group.degree(), generators, orbit.begin(), orbit.end()));
+
+    order *= restrictions.back().order();
+  }
+
+  // otherwise the group is only a subdirect product of its restrictions
+  if (order != group.order())
+    return false;
+
+  dist = {1};
+  for (auto const &restriction : restrictions)
+    dist = fixed_points_combine(dist, fixed_points_moved(restriction, aborted));
+
+  return true;
+}
+
+// a transitive group whose kernel of the action on some block system is the
+// full direct product of the block stabilizers (restricted to their blocks)
+// is the wreath product of one such stabilizer K with the block permuter H,
+// an element only fixes points in the blocks its image in H fixes and over
+// all elements with the same image these points are distributed like those
+// fixed by independently chosen elements of K
+bool fixed_points_wreath_product(PermGroup const &group,
+                                 std::vector<unsigned> const &support,
+                                 std::vector<BSGS::order_type> &dist,
+                                 timeout::flag aborted)
+{
+  using boost::multiprecision::pow;
+
+  unsigned degree = static_cast<unsigned>(support.size());
+
+  // block systems are only determined for groups transitive on all points
+  std::vector<unsigned> support_index(group.degree());
+  for (unsigned i = 0u; i < degree; ++i)
+    support_index[support[i]] = i;
+
+  PermSet generators;
+  for (Perm const &gen : group.generators()) {
+    std::vector<unsigned> perm(degree);
+    for (unsigned i = 0u; i < degree; ++i)
+      perm[i] = support_index[gen[support[i]]];
+
+    generators.insert(Perm(perm));
+  }
+
+  // the bsgs of a group without fixed points can be reused
+  PermGroup transitive_group(degree == group.degree()
+                               ? group : PermGroup(degree, generators));
+
+  auto const &bsgs(transitive_group.bsgs());
+  unsigned first = bsgs.base_point(0);
+
+  // block systems are determined by the block containing a fixed point
+  std::set<std::vector<unsigned>> blocks_considered;
+
+  for (unsigned x = 0u; x < degree; ++x) {
+    if (timeout::is_set(aborted))
+      throw timeout::AbortedError("fixed_points_distribution");
+
+    if (x == first)
+      continue;
+
+    auto block_system(BlockSystem::minimal(generators, {first, x}));
+
+    auto const &block(block_system[block_system.block_index(first)]);
+
+    if (block.size() == degree || !blocks_considered.insert(block).second)
+      continue;
+
+    unsigned num_blocks = block_system.size();
+
+    PermGroup block_permuter(num_blocks,
+                             block_system.block_permuter(generators));
+
+    // the stabilizer of the block is generated by the stabilizer of its
+    // first point and elements mapping that point to the other points in it
+    PermSet block_stabilizer_generators;
+    if (bsgs.base_size() > 1u)
+      block_stabilizer_generators = bsgs.stabilizers(1);
+
+    for (unsigned y : block) {
+      if (y != first)
+        block_stabilizer_generators.insert(bsgs.transversal(0, y));
+    }
+
+    auto block_stabilizer(fixed_points_restricted_group(
+      degree, block_stabilizer_generators, block.begin(), block.end()));
+
+    BSGS::order_type block_stabilizer_order = block_stabilizer.order();
+
+    if (pow(block_stabilizer_order, num_blocks) * block_permuter.order() !=
+        group.order()) {
+      continue;
+    }
+
+    auto dist_block_permuter(fixed_points_pad(
+      fixed_points_moved(block_permuter, aborted), num_blocks));
+
+    auto dist_block_stabilizer(fixed_points_pad(
+      fixed_points_moved(block_stabilizer, aborted), block.size()));
+
+    dist.assign(degree + 1u, 0);
+
+    std::vector<BSGS::order_type> dist_fixed_blocks{1};
+
+    for (unsigned j = 0u; j <= num_blocks; ++j) {
+      if (j > 0u) {
+        dist_fixed_blocks = fixed_points_combine(dist_fixed_blocks,
+                                                 dist_block_stabilizer);
+      }
+
+      if (dist_block_permuter[j] == 0)
+        continue;
+
+      BSGS::order_type weight =
+        dist_block_permuter[j] * pow(block_stabilizer_order, num_blocks - j);
+
+      for (unsigned k = 0u; k < dist_fixed_blocks.size(); ++k)
+        dist[k] += weight * dist_fixed_blocks[k];
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
+// distribution over the points moved by group
+std::vector<BSGS::order_type> fixed_points_moved(PermGroup const &group,
+                                                 timeout::flag aborted)
+{
+  if (group.is_trivial())
+    return {1};
+
+  auto support(group.support());
+
+  if (group.order() == PermGroup::symmetric_order(support.size()))
+    return fixed_points_symmetric(support.size());
+
+  bool transitive = Orbit::generate(
+    support[0], group.generators().with_inverses()).size() == support.size();
+
+  std::vector<BSGS::order_type> dist;
+
+  if (transitive ? fixed_points_wreath_product(group, support, dist, aborted)
+                 : fixed_points_direct_product(group, support, dist, aborted)) {
+    return dist;
+  }
+
+  return fixed_points_enumerate(group, support, aborted);
+}
+
+} // anonymous namespace
+
 namespace mpsym
 {
 
@@ -224,6 +522,30 @@ bool PermGroup::is_shifted_symmetric() const
   return _order == symmetric_order(degree_);
 }
 
+std::vector<BSGS::order_type> PermGroup::fixed_points_distribution(
+  timeout::flag aborted) const
+{
+  // the fixed points of an element of a direct product of groups with
+  // disjoint supports are the union of the fixed points of its components,
+  // the distribution can thus be assembled from those of the factors of a
+  // disjoint decomposition (which need not be the finest one), factors are
+  // in turn decomposed into direct and wreath products where possible and
+  // only enumerated element by element as a last resort
+  std::vector<BSGS::order_type> dist{1};
+
+  if (is_transitive()) {
+    dist = fixed_points_moved(*this, aborted);
+
+  } else if (!is_trivial()) {
+    for (auto const &factor : disjoint_decomposition(false)) {
+      if (!factor.is_trivial())
+        dist = fixed_points_combine(dist, fixed_points_moved(factor, aborted));
+    }
+  }
+
+  return fixed_points_pad(dist, degree());
+}
+
 bool PermGroup::is_transitive() const
 {
   auto orbit(Orbit::generate(0u, generators().with_inverses()));
@@ -238,9 +560,25 @@ bool PermGroup::contains_element(Perm const &perm) const
   return _bsgs.strips_completely(perm);
 }
 
+std::vector<bool> PermGroup::contains_elements(std::vector<Perm> const &perms,
+                                               unsigned num_threads) const
+{ return _bsgs.strips_completely(perms, num_threads); }
+
 Perm PermGroup::random_element() const
 {
-  static auto re(util::random_engine());
+  thread_local auto re(util::random_engine());
+
+  if (has_pcgs()) {
+    auto relative_orders(pcgs_relative_orders());
+
+    std::vector<unsigned> exponents(relative_orders.size());
+    for (unsigned i = 0u; i < exponents.size(); ++i) {
+      std::uniform_int_distribution<unsigned> d(0u, relative_orders[i] - 1u);
+      exponents[i] = d(re);
+    }
+
+    return pcgs_element(exponents);
+  }
 
   Perm result(degree());
   for (unsigned i = 0u; i < _bsgs.base_size(); ++i) {
@@ -263,6 +601,19 @@ PermGroup::const_iterator::const_iterator(PermGroup const &pg)
 
     _current_valid = true;
 
+  } else if (pg.has_pcgs()) {
+    // iterate over the exponent vectors of the polycyclic generating sequence
+    for (unsigned i = 0u; i < pg.bsgs().pcgs_relative_orders().size(); ++i) {
+      _state.push_back(0u);
+
+      auto const &powers(pg.bsgs().pcgs_powers(i));
+
+      _transversals.emplace_back(powers.begin(), powers.end());
+      _current_factors.insert(powers[0]);
+    }
+
+    _current_valid = false;
+
   } else {
     for (unsigned i = 0u; i < pg.bsgs().base_size(); ++i) {
       _state.push_back(0u);
@@ -50,7 +50,7 @@ PrRandomizer::PrRandomizer(PermSet const &generators,
 
 Perm PrRandomizer::next()
 {
-  static auto re(util::random_engine());
+  thread_local auto re(util::random_engine());
 
   std::uniform_int_distribution<> randbool(0, 1);
   std::uniform_int_distribution<> rands(1, _gens.size() - 1);
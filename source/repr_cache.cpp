@@ -0,0 +1,74 @@
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+#include "repr_cache.hpp"
+#include "task_mapping.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+std::size_t ReprCache::size() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  return _lru.size();
+}
+
+bool ReprCache::lookup(TaskMapping const &mapping,
+                       unsigned offset,
+                       TaskMapping &representative)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  auto it(_lru_index.find(key_type(offset, mapping)));
+  if (it == _lru_index.end()) {
+    ++_misses;
+    return false;
+  }
+
+  _lru.splice(_lru.begin(), _lru, it->second);
+
+  representative = it->second->second;
+
+  ++_hits;
+  return true;
+}
+
+void ReprCache::insert(TaskMapping const &mapping,
+                       unsigned offset,
+                       TaskMapping const &representative)
+{
+  if (_capacity == 0u)
+    return;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  key_type key(offset, mapping);
+
+  if (_lru_index.find(key) != _lru_index.end())
+    return;
+
+  if (_lru.size() == _capacity) {
+    _lru_index.erase(_lru.back().first);
+    _lru.pop_back();
+  }
+
+  _lru.emplace_front(key, representative);
+  _lru_index[key] = _lru.begin();
+}
+
+void ReprCache::clear()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  _lru.clear();
+  _lru_index.clear();
+}
+
+} // namespace internal
+
+} // namespace mpsym
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/random/uniform_int_distribution.hpp>
+
+#include "arch_graph_automorphisms.hpp"
+#include "arch_graph_system.hpp"
+#include "bsgs.hpp"
+#include "repr_sampler.hpp"
+#include "task_mapping.hpp"
+#include "timeout.hpp"
+
+namespace mpsym
+{
+
+using namespace internal;
+
+ReprSampler::ReprSampler(ArchGraphSystem &ags,
+                         unsigned num_tasks,
+                         bool injective,
+                         bool weighted,
+                         seed_type seed,
+                         timeout::flag aborted)
+: _automorphisms(ags.automorphisms(nullptr, aborted)),
+  _num_tasks(num_tasks),
+  _degree(_automorphisms.automorphisms_degree()),
+  _injective(injective),
+  _weighted(weighted),
+  _generator(ags.orbit_reprs(num_tasks, injective, TaskMapping(), nullptr, aborted)),
+  _num_orbits(_generator.size()),
+  _engine(seed)
+{
+  if (_num_orbits == 0)
+    throw std::invalid_argument("no task mappings to sample from");
+}
+
+TaskMapping ReprSampler::operator()()
+{ return _weighted ? sample_weighted() : sample_uniform(); }
+
+TaskMapping ReprSampler::sample_uniform()
+{
+  BSGS::order_type rank;
+
+  {
+    std::lock_guard<std::mutex> lock(_engine_mutex);
+
+    boost::random::uniform_int_distribution<BSGS::order_type> d_rank(
+      0, _num_orbits - 1);
+
+    rank = d_rank(_engine);
+  }
+
+  return _generator.unrank(rank);
+}
+
+TaskMapping ReprSampler::sample_weighted()
+{
+  std::vector<unsigned> mapping(_num_tasks);
+
+  {
+    std::lock_guard<std::mutex> lock(_engine_mutex);
+
+    if (_injective) {
+      // partial fisher yates shuffle
+      std::vector<unsigned> pes(_degree);
+      std::iota(pes.begin(), pes.end(), 0u);
+
+      for (unsigned i = 0u; i < _num_tasks; ++i) {
+        std::uniform_int_distribution<unsigned> d_pe(i, _degree - 1u);
+        std::swap(pes[i], pes[d_pe(_engine)]);
+
+        mapping[i] = pes[i];
+      }
+    } else {
+      std::uniform_int_distribution<unsigned> d_pe(0u, _degree - 1u);
+
+      for (unsigned i = 0u; i < _num_tasks; ++i)
+        mapping[i] = d_pe(_engine);
+    }
+  }
+
+  // backtracking yields the lexicographically minimal representative
+  ReprOptions options;
+  options.method = ReprOptions::Method::BACKTRACK;
+
+  return _automorphisms.repr(mapping, &options);
+}
+
+} // namespace mpsym
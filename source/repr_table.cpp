@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "dbg.hpp"
+#include "parallel.hpp"
+#include "perm.hpp"
+#include "perm_set.hpp"
+#include "repr_table.hpp"
+#include "task_mapping.hpp"
+#include "timeout.hpp"
+
+namespace
+{
+
+std::uint64_t const MAGIC = 0x6c6274726d79736dull; // "msymrtbl"
+std::uint64_t const VERSION = 1u;
+
+std::size_t const CHUNK_SIZE = 1u << 16;
+
+struct Header
+{
+  std::uint64_t magic;
+  std::uint64_t version;
+  std::uint64_t architecture_hash;
+  std::uint64_t degree;
+  std::uint64_t num_tasks;
+  std::uint64_t size;
+  std::uint64_t num_orbits;
+};
+
+[[noreturn]] void throw_errno(std::string const &what, std::string const &path)
+{
+  throw std::runtime_error(
+    what + " '" + path + "': " + std::strerror(errno));
+}
+
+std::uint64_t table_size(unsigned degree,
+                         unsigned num_tasks,
+                         std::uint64_t max_size)
+{
+  std::uint64_t size = 1u;
+
+  for (unsigned i = 0u; i < num_tasks; ++i) {
+    size *= degree;
+
+    if (size > max_size)
+      throw std::invalid_argument("too many task mappings for table");
+  }
+
+  return size;
+}
+
+} // anonymous namespace
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+ReprTable::ReprTable(PermSet const &generators,
+                     unsigned degree,
+                     unsigned num_tasks,
+                     unsigned num_threads,
+                     std::uint64_t max_size,
+                     timeout::flag aborted)
+: _degree(degree),
+  _num_tasks(num_tasks),
+  _table(table_size(
+    degree,
+    num_tasks,
+    std::min(max_size,
+             static_cast<std::uint64_t>(
+               std::numeric_limits<std::uint32_t>::max()))))
+{
+  DBG(DEBUG) << "Building representative table of size " << _table.size();
+
+  if (num_threads == 0u)
+    num_threads = util::hardware_threads();
+
+  util::parallel_for(
+    _table.size(),
+    num_threads,
+    [&](std::size_t begin, std::size_t end, unsigned)
+    {
+      for (std::size_t x = begin; x < end; ++x)
+        _table[x].store(static_cast<std::uint32_t>(x),
+                        std::memory_order_relaxed);
+    });
+
+  // every mapping is united with its images under all generators, since
+  // roots are always the smaller element, the root of each orbit is its
+  // lexicographically minimal element
+  util::parallel_for(
+    _table.size(),
+    num_threads,
+    [&](std::size_t begin, std::size_t end, unsigned)
+    {
+      for (std::size_t x = begin; x < end; ++x) {
+        if (x % CHUNK_SIZE == 0u && timeout::is_set(aborted))
+          throw timeout::AbortedError("representative table");
+
+        TaskMapping mapping(decode(static_cast<std::uint32_t>(x)));
+
+        for (auto const &gen : generators)
+          unite(static_cast<std::uint32_t>(x), encode(mapping.permuted(gen)));
+      }
+    });
+
+  std::vector<std::uint64_t> num_orbits(num_threads, 0u);
+
+  util::parallel_for(
+    _table.size(),
+    num_threads,
+    [&](std::size_t begin, std::size_t end, unsigned thread)
+    {
+      for (std::size_t x = begin; x < end; ++x) {
+        std::uint32_t root = find(static_cast<std::uint32_t>(x));
+
+        _table[x].store(root, std::memory_order_relaxed);
+
+        if (root == x)
+          ++num_orbits[thread];
+      }
+    });
+
+  for (auto n : num_orbits)
+    _num_orbits += n;
+
+  DBG(DEBUG) << "Representative table contains " << _num_orbits << " orbits";
+}
+
+ReprTable::ReprTable(std::string const &path, std::uint64_t architecture_hash)
+{
+  std::FILE *file = std::fopen(path.c_str(), "rb");
+  if (!file)
+    throw_errno("failed to open", path);
+
+  auto error = [&](std::string const &what)
+  { return std::runtime_error(what + " representative table '" + path + "'"); };
+
+  try {
+    Header header;
+
+    if (std::fread(&header, sizeof(Header), 1u, file) != 1u ||
+        header.magic != MAGIC ||
+        header.version != VERSION) {
+      throw error("malformed");
+    }
+
+    if (header.architecture_hash != architecture_hash)
+      throw error("architecture mismatch in");
+
+    _degree = static_cast<unsigned>(header.degree);
+    _num_tasks = static_cast<unsigned>(header.num_tasks);
+    _num_orbits = header.num_orbits;
+
+    if (header.size != table_size(_degree,
+                                  _num_tasks,
+                                  std::numeric_limits<std::uint32_t>::max())) {
+      throw error("malformed");
+    }
+
+    _table = std::vector<std::atomic<std::uint32_t>>(header.size);
+
+    std::vector<std::uint32_t> chunk(CHUNK_SIZE);
+
+    for (std::size_t i = 0u; i < _table.size(); i += chunk.size()) {
+      std::size_t n = std::min(chunk.size(), _table.size() - i);
+
+      if (std::fread(chunk.data(), sizeof(std::uint32_t), n, file) != n)
+        throw error("truncated");
+
+      for (std::size_t j = 0u; j < n; ++j) {
+        if (chunk[j] > i + j)
+          throw error("malformed");
+
+        _table[i + j].store(chunk[j], std::memory_order_relaxed);
+      }
+    }
+
+  } catch (...) {
+    std::fclose(file);
+    throw;
+  }
+
+  std::fclose(file);
+}
+
+void ReprTable::save(std::string const &path,
+                     std::uint64_t architecture_hash) const
+{
+  // write to a temporary file first so that a crash never leaves a partially
+  // written table behind
+  std::string path_tmp(path + ".tmp");
+
+  std::FILE *file = std::fopen(path_tmp.c_str(), "wb");
+  if (!file)
+    throw_errno("failed to open", path_tmp);
+
+  Header header {MAGIC,
+                 VERSION,
+                 architecture_hash,
+                 _degree,
+                 _num_tasks,
+                 _table.size(),
+                 _num_orbits};
+
+  bool ok = std::fwrite(&header, sizeof(Header), 1u, file) == 1u;
+
+  std::vector<std::uint32_t> chunk(CHUNK_SIZE);
+
+  for (std::size_t i = 0u; ok && i < _table.size(); i += chunk.size()) {
+    std::size_t n = std::min(chunk.size(), _table.size() - i);
+
+    for (std::size_t j = 0u; j < n; ++j)
+      chunk[j] = _table[i + j].load(std::memory_order_relaxed);
+
+    ok = std::fwrite(chunk.data(), sizeof(std::uint32_t), n, file) == n;
+  }
+
+  if (std::fclose(file) != 0)
+    ok = false;
+
+  if (!ok) {
+    std::remove(path_tmp.c_str());
+    throw_errno("failed to write", path_tmp);
+  }
+
+  if (std::rename(path_tmp.c_str(), path.c_str()) != 0)
+    throw_errno("failed to rename", path_tmp);
+}
+
+bool ReprTable::contains(TaskMapping const &mapping, unsigned offset) const
+{
+  if (mapping.size() != _num_tasks)
+    return false;
+
+  return std::all_of(mapping.begin(),
+                     mapping.end(),
+                     [&](unsigned task)
+                     { return task >= offset && task - offset < _degree; });
+}
+
+std::uint32_t ReprTable::encode(TaskMapping const &mapping,
+                                unsigned offset) const
+{
+  std::uint32_t code = 0u;
+
+  for (unsigned task : mapping)
+    code = code * _degree + (task - offset);
+
+  return code;
+}
+
+TaskMapping ReprTable::decode(std::uint32_t code, unsigned offset) const
+{
+  std::vector<unsigned> mapping(_num_tasks);
+
+  for (unsigned i = _num_tasks; i-- > 0u;) {
+    mapping[i] = code % _degree + offset;
+    code /= _degree;
+  }
+
+  return TaskMapping(mapping);
+}
+
+std::uint32_t ReprTable::find(std::uint32_t x)
+{
+  // path halving, concurrent updates can only ever make parents smaller
+  for (;;) {
+    std::uint32_t parent = _table[x].load(std::memory_order_relaxed);
+    if (parent == x)
+      return x;
+
+    std::uint32_t grandparent = _table[parent].load(std::memory_order_relaxed);
+    if (grandparent != parent)
+      _table[x].compare_exchange_weak(parent, grandparent,
+                                      std::memory_order_relaxed);
+
+    x = grandparent;
+  }
+}
+
+void ReprTable::unite(std::uint32_t x, std::uint32_t y)
+{
+  for (;;) {
+    x = find(x);
+    y = find(y);
+
+    if (x == y)
+      return;
+
+    if (x > y)
+      std::swap(x, y);
+
+    // link the larger root below the smaller one unless it has stopped
+    // being a root in the meantime
+    std::uint32_t expected = y;
+    if (_table[y].compare_exchange_strong(expected, x,
+                                          std::memory_order_relaxed)) {
+      return;
+    }
+  }
+}
+
+} // namespace internal
+
+} // namespace mpsym
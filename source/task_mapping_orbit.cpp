@@ -1,102 +1,264 @@
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <limits>
-#include <set>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
-#include "hash.hpp"
+#include "packed_task_mapping.hpp"
+#include "parallel.hpp"
+#include "perm.hpp"
+#include "perm_set.hpp"
 #include "task_mapping.hpp"
 #include "task_mapping_orbit.hpp"
+#include "timeout.hpp"
 #include "util.hpp"
 
 namespace mpsym
 {
 
+using namespace internal;
+
+TMO::IterationState::IterationState(TMO const *orbit)
+: current(orbit->_root),
+  _orbit(orbit)
+{
+  if (!_orbit->_generators.empty())
+    init_hash();
+
+  if (_perfect_hash) {
+    hash_type h = perfect_hash(current);
+
+    _processed_hashes.set(h);
+    _level_hashes.push_back(h);
+
+  } else {
+    internal::PackedTaskMapping packed(current);
+
+    _processed_mappings.reset(new ProcessedSet);
+    _processed_mappings->insert(packed);
+    _level_mappings.push_back(packed);
+  }
+}
+
 void TMO::IterationState::advance()
 {
   if (exhausted())
     return;
 
-  auto current_copy(*current);
-  _unprocessed.erase(current);
+  if (++_level_pos == level_size()) {
+    expand(nullptr, timeout::unset());
 
-  if (_singular)
-    return;
+    if (level_size() == 0u) {
+      _exhausted = true;
+      return;
+    }
+  }
+
+  current = level_mapping(_level_pos);
+}
+
+bool TMO::IterationState::expand(visitor const &visit, timeout::flag aborted)
+{
+  auto const &generators(_orbit->_generators);
+  unsigned offset = _orbit->_offset;
+
+  unsigned num_threads = _orbit->_num_threads;
+  if (num_threads == 0u)
+    num_threads = util::hardware_threads();
+
+  // mappings are marked as processed as soon as they are discovered so that
+  // every mapping ends up in exactly one level
+  std::vector<std::vector<hash_type>> next_hashes(num_threads);
+  std::vector<std::vector<internal::PackedTaskMapping>> next_mappings(num_threads);
+
+  std::atomic<bool> done(false);
+
+  util::parallel_for(
+    level_size(),
+    num_threads,
+    [&](std::size_t begin, std::size_t end, unsigned thread)
+    {
+      for (std::size_t i = begin; i < end; ++i) {
+        if (done.load(std::memory_order_relaxed))
+          return;
+
+        if (timeout::is_set(aborted))
+          throw timeout::AbortedError("orbit enumeration");
+
+        TaskMapping mapping(level_mapping(i));
+
+        for (auto const &gen : generators) {
+          bool discovered;
+          TaskMapping next;
+
+          if (_perfect_hash) {
+            hash_type h = perfect_hash_permuted(mapping, gen);
+
+            discovered = _processed_hashes.set(h);
+            if (discovered)
+              next_hashes[thread].push_back(h);
 
-  _processed.insert(_hash(current_copy));
+          } else {
+            next = mapping.permuted(gen, offset);
 
-  for (auto const &gen : *_generators) {
-    TaskMapping next(current_copy.permuted(gen));
+            internal::PackedTaskMapping packed(next);
 
-    if (_processed.find(_hash(next)) == _processed.end())
-      _unprocessed.insert(next);
+            discovered = _processed_mappings->insert(packed);
+            if (discovered)
+              next_mappings[thread].push_back(packed);
+          }
+
+          if (!discovered || !visit)
+            continue;
+
+          // perfect hashes are computed without permuting the mapping
+          if (_perfect_hash)
+            next = mapping.permuted(gen, offset);
+
+          if (visit(next, thread)) {
+            done.store(true, std::memory_order_relaxed);
+            return;
+          }
+        }
+      }
+    });
+
+  _level_hashes.clear();
+  _level_mappings.clear();
+  _level_pos = 0u;
+
+  for (unsigned t = 0u; t < num_threads; ++t) {
+    _level_hashes.insert(_level_hashes.end(),
+                         next_hashes[t].begin(),
+                         next_hashes[t].end());
+
+    _level_mappings.insert(_level_mappings.end(),
+                           next_mappings[t].begin(),
+                           next_mappings[t].end());
   }
 
-  current = _unprocessed.begin();
+  return done.load();
 }
 
-bool TMO::IterationState::exhausted() const
-{ return _unprocessed.empty(); }
-
-void TMO::IterationState::init_hash(TaskMapping const &root)
+void TMO::IterationState::init_hash()
 {
-  auto support(_generators->support());
+  auto const &generators(_orbit->_generators);
+  auto const &root(_orbit->_root);
+  unsigned offset = _orbit->_offset;
 
-  std::set<unsigned> support_set(support.begin(), support.end());
-  for (unsigned task : root)
-    support_set.insert(task);
+  // tasks not moved by any generator are the same for all orbit elements
+  auto support(generators.support());
 
-  unsigned n = support_set.size();
-  unsigned k = root.size();
+  _hash_support_index.assign(generators.degree(), 0u);
+  for (unsigned i = 0u; i < support.size(); ++i)
+    _hash_support_index[support[i]] = i;
+
+  std::vector<bool> in_support(generators.degree(), false);
+  for (unsigned x : support)
+    in_support[x] = true;
+
+  for (unsigned i = 0u; i < root.size(); ++i) {
+    unsigned task = root[i];
+
+    if (task >= offset && task < offset + generators.degree() &&
+        in_support[task - offset]) {
+      _hash_positions.push_back(i);
+    }
+  }
 
   uint64_t orbit_size_limit = 1;
-  for (unsigned i = 0u; i < k; ++i) {
-    orbit_size_limit *= n;
-    if (orbit_size_limit >= std::numeric_limits<hash_type>::max()) {
-      _hash = container_hash_truncated;
+  for (unsigned i = 0u; i < _hash_positions.size(); ++i) {
+    orbit_size_limit *= support.size();
+    if (orbit_size_limit >= std::numeric_limits<hash_type>::max())
       return;
-    }
   }
 
-  unsigned i = 0u;
-  for (unsigned task : support_set)
-    _hash_support_map[task] = i++;
+  _perfect_hash = true;
+  _hash_support.assign(support.begin(), support.end());
 
-  _hash = [&](TaskMapping const &mapping){ return perfect_hash(mapping); };
+  _processed_hashes.resize(orbit_size_limit);
 }
 
 TMO::IterationState::hash_type TMO::IterationState::perfect_hash(
   TaskMapping const &mapping) const
 {
+  unsigned offset = _orbit->_offset;
+
   hash_type h = 0u;
 
   hash_type factor = 1u;
-  for (unsigned task : mapping) {
-    auto it(_hash_support_map.find(task));
-    assert(it != _hash_support_map.end());
+  for (unsigned i : _hash_positions) {
+    h += _hash_support_index[mapping[i] - offset] * factor;
+    factor *= _hash_support.size();
+  }
+
+  return h;
+}
 
-    h += it->second * factor;
-    factor *= _hash_support_map.size();
+TMO::IterationState::hash_type TMO::IterationState::perfect_hash_permuted(
+  TaskMapping const &mapping,
+  internal::Perm const &perm) const
+{
+  unsigned offset = _orbit->_offset;
+
+  hash_type h = 0u;
+
+  hash_type factor = 1u;
+  for (unsigned i : _hash_positions) {
+    h += _hash_support_index[perm[mapping[i] - offset]] * factor;
+    factor *= _hash_support.size();
   }
 
   return h;
 }
 
-TMO::IterationState::hash_type TMO::IterationState::container_hash_truncated(
-  TaskMapping const &mapping)
-{ return util::container_hash(mapping.begin(), mapping.end()); }
+TaskMapping TMO::IterationState::perfect_unhash(hash_type h) const
+{
+  unsigned offset = _orbit->_offset;
+
+  TaskMapping mapping(_orbit->_root);
+
+  for (unsigned i : _hash_positions) {
+    mapping[i] = _hash_support[h % _hash_support.size()] + offset;
+    h /= _hash_support.size();
+  }
+
+  return mapping;
+}
+
+bool TMO::for_each(visitor const &visit, timeout::flag aborted) const
+{
+  if (visit(_root, 0u))
+    return true;
+
+  IterationState state(this);
+
+  while (state.level_size() > 0u) {
+    if (state.expand(visit, aborted))
+      return true;
+  }
+
+  return false;
+}
 
 std::pair<bool, unsigned> TMORs::insert(TaskMapping const &mapping)
 {
   bool new_orbit;
   unsigned equivalence_class;
 
-  auto it = _orbit_reprs.find(mapping);
+  internal::PackedTaskMapping packed(mapping);
+
+  auto it = _orbit_reprs.find(packed);
   if (it == _orbit_reprs.end()) {
     new_orbit = true;
     equivalence_class = num_orbits();
 
-    _orbit_reprs[mapping] = equivalence_class;
+    _orbit_reprs[packed] = equivalence_class;
 
   } else {
     new_orbit = false;
@@ -106,4 +268,101 @@ std::pair<bool, unsigned> TMORs::insert(TaskMapping const &mapping)
   return {new_orbit, equivalence_class};
 }
 
+std::pair<TMORs, std::vector<std::vector<unsigned>>> TMORs::merge(
+  std::vector<TMORs const *> const &orbits)
+{
+  std::unordered_set<internal::PackedTaskMapping> reprs_packed;
+  for (TMORs const *o : orbits) {
+    for (auto const &repr : o->_orbit_reprs)
+      reprs_packed.insert(repr.first);
+  }
+
+  std::vector<TaskMapping> reprs;
+  reprs.reserve(reprs_packed.size());
+
+  for (auto const &repr : reprs_packed)
+    reprs.push_back(repr.unpack());
+
+  reprs_packed.clear();
+
+  std::sort(reprs.begin(), reprs.end());
+
+  TMORs merged;
+  for (auto const &repr : reprs)
+    merged.insert(repr);
+
+  std::vector<std::vector<unsigned>> remaps;
+  remaps.reserve(orbits.size());
+
+  for (TMORs const *o : orbits) {
+    std::vector<unsigned> remap(o->num_orbits());
+
+    for (auto const &repr : o->_orbit_reprs) {
+      assert(repr.second < remap.size());
+      remap[repr.second] = merged._orbit_reprs.at(repr.first);
+    }
+
+    remaps.push_back(remap);
+  }
+
+  return {merged, remaps};
+}
+
+ConcurrentTMORs::ConcurrentTMORs(unsigned num_shards)
+{
+  if (num_shards == 0u)
+    throw std::invalid_argument("number of shards must be positive");
+
+  for (unsigned i = 0u; i < num_shards; ++i)
+    _shards.emplace_back(new Shard);
+}
+
+std::pair<bool, unsigned> ConcurrentTMORs::insert(TaskMapping const &mapping)
+{
+  internal::PackedTaskMapping packed(mapping);
+
+  auto &s(shard(packed));
+
+  std::lock_guard<std::mutex> lock(s.mutex);
+
+  auto it = s.orbit_reprs.find(packed);
+  if (it != s.orbit_reprs.end())
+    return {false, it->second};
+
+  unsigned equivalence_class = _num_orbits++;
+
+  s.orbit_reprs[packed] = equivalence_class;
+
+  return {true, equivalence_class};
+}
+
+bool ConcurrentTMORs::is_repr(TaskMapping const &mapping) const
+{
+  internal::PackedTaskMapping packed(mapping);
+
+  auto &s(shard(packed));
+
+  std::lock_guard<std::mutex> lock(s.mutex);
+
+  return s.orbit_reprs.find(packed) != s.orbit_reprs.end();
+}
+
+std::vector<TaskMapping> ConcurrentTMORs::reprs() const
+{
+  std::vector<TaskMapping> res;
+
+  for (auto const &s : _shards) {
+    std::lock_guard<std::mutex> lock(s->mutex);
+
+    for (auto const &repr : s->orbit_reprs) {
+      if (repr.second >= res.size())
+        res.resize(repr.second + 1u);
+
+      res[repr.second] = repr.first.unpack();
+    }
+  }
+
+  return res;
+}
+
 } // namespace mpsym
@@ -0,0 +1,479 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "dbg.hpp"
+#include "perm.hpp"
+#include "perm_set.hpp"
+#include "task_mapping.hpp"
+#include "task_mapping_orbit_external.hpp"
+#include "timeout.hpp"
+
+namespace
+{
+
+// number of sorted runs merged at once
+unsigned const MAX_MERGE_FAN_IN = 64u;
+
+[[noreturn]] void throw_errno(std::string const &what, std::string const &path)
+{
+  throw std::runtime_error(
+    what + " '" + path + "': " + std::strerror(errno));
+}
+
+bool record_less(unsigned const *lhs, unsigned const *rhs, unsigned num_tasks)
+{
+  return std::lexicographical_compare(
+    lhs, lhs + num_tasks, rhs, rhs + num_tasks);
+}
+
+bool record_equal(unsigned const *lhs, unsigned const *rhs, unsigned num_tasks)
+{ return std::equal(lhs, lhs + num_tasks, rhs); }
+
+// files of fixed size records of num_tasks tasks each
+class RecordWriter
+{
+public:
+  RecordWriter(std::string const &path, unsigned num_tasks)
+  : _path(path),
+    _num_tasks(num_tasks)
+  {
+    _file = std::fopen(path.c_str(), "wb");
+    if (!_file)
+      throw_errno("failed to open", path);
+  }
+
+  ~RecordWriter()
+  {
+    if (_file)
+      std::fclose(_file);
+  }
+
+  RecordWriter(RecordWriter const &) = delete;
+  RecordWriter &operator=(RecordWriter const &) = delete;
+
+  void write(unsigned const *record)
+  {
+    if (std::fwrite(record, sizeof(unsigned), _num_tasks, _file) != _num_tasks)
+      throw_errno("failed to write", _path);
+  }
+
+  void close()
+  {
+    int res = std::fclose(_file);
+    _file = nullptr;
+
+    if (res != 0)
+      throw_errno("failed to close", _path);
+  }
+
+private:
+  std::string _path;
+  unsigned _num_tasks;
+  std::FILE *_file;
+};
+
+class RecordReader
+{
+public:
+  RecordReader(std::string const &path, unsigned num_tasks)
+  : _path(path),
+    _record(num_tasks)
+  {
+    _file = std::fopen(path.c_str(), "rb");
+    if (!_file)
+      throw_errno("failed to open", path);
+
+    next();
+  }
+
+  ~RecordReader()
+  { std::fclose(_file); }
+
+  RecordReader(RecordReader const &) = delete;
+  RecordReader &operator=(RecordReader const &) = delete;
+
+  bool valid() const
+  { return _valid; }
+
+  unsigned const *record() const
+  { return _record.data(); }
+
+  void next()
+  {
+    std::size_t n = std::fread(_record.data(),
+                               sizeof(unsigned),
+                               _record.size(),
+                               _file);
+
+    if (n != _record.size()) {
+      if (std::ferror(_file))
+        throw_errno("failed to read", _path);
+
+      _valid = false;
+    }
+  }
+
+  // skip all records smaller than record, returns true if record is found
+  bool seek(unsigned const *record)
+  {
+    while (_valid && record_less(_record.data(), record, _record.size()))
+      next();
+
+    return _valid && record_equal(_record.data(), record, _record.size());
+  }
+
+private:
+  std::string _path;
+  std::FILE *_file;
+  std::vector<unsigned> _record;
+  bool _valid = true;
+};
+
+// merges sorted record files, yielding every distinct record once
+class RecordMerger
+{
+public:
+  RecordMerger(std::vector<std::string> const &paths, unsigned num_tasks)
+  : _num_tasks(num_tasks),
+    _queue(Compare{this})
+  {
+    for (auto const &path : paths) {
+      _readers.emplace_back(new RecordReader(path, num_tasks));
+
+      if (_readers.back()->valid())
+        _queue.push(_readers.size() - 1u);
+    }
+  }
+
+  // copies the next distinct record to record, returns false if exhausted
+  bool next(std::vector<unsigned> &record)
+  {
+    if (_queue.empty())
+      return false;
+
+    unsigned const *top = _readers[_queue.top()]->record();
+    record.assign(top, top + _num_tasks);
+
+    while (!_queue.empty()) {
+      auto i = _queue.top();
+
+      if (!record_equal(_readers[i]->record(), record.data(), _num_tasks))
+        break;
+
+      _queue.pop();
+
+      _readers[i]->next();
+      if (_readers[i]->valid())
+        _queue.push(i);
+    }
+
+    return true;
+  }
+
+private:
+  struct Compare
+  {
+    bool operator()(std::size_t lhs, std::size_t rhs) const
+    {
+      return record_less(merger->_readers[rhs]->record(),
+                         merger->_readers[lhs]->record(),
+                         merger->_num_tasks);
+    }
+
+    RecordMerger const *merger;
+  };
+
+  unsigned _num_tasks;
+  std::vector<std::unique_ptr<RecordReader>> _readers;
+  std::priority_queue<std::size_t, std::vector<std::size_t>, Compare> _queue;
+};
+
+} // anonymous namespace
+
+namespace mpsym
+{
+
+using namespace internal;
+
+// temporary files of a single enumeration, removed once no longer needed
+class ExternalTMO::TempFiles
+{
+public:
+  explicit TempFiles(std::string const &directory)
+  {
+    static std::atomic<unsigned> enumeration_count(0u);
+
+    _prefix = directory + "/mpsym_tmo_" + std::to_string(::getpid()) + "_" +
+              std::to_string(enumeration_count++);
+  }
+
+  ~TempFiles()
+  {
+    for (auto const &path : _paths)
+      std::remove(path.c_str());
+  }
+
+  std::string create(std::string const &what)
+  {
+    _paths.push_back(_prefix + "." + what + std::to_string(_count++));
+    return _paths.back();
+  }
+
+  void remove(std::string const &path)
+  {
+    std::remove(path.c_str());
+    _paths.erase(std::find(_paths.begin(), _paths.end(), path));
+  }
+
+  void remove(std::vector<std::string> const &paths)
+  {
+    for (auto const &path : paths)
+      remove(path);
+  }
+
+private:
+  std::string _prefix;
+  std::vector<std::string> _paths;
+  unsigned _count = 0u;
+};
+
+ExternalTMO::ExternalTMO(TaskMapping const &mapping,
+                         PermSet const &generators,
+                         std::string const &directory,
+                         std::size_t memory_limit,
+                         unsigned offset)
+: _root(mapping),
+  _generators(generators.empty() ? generators : generators.with_inverses()),
+  _directory(directory),
+  _memory_limit(memory_limit),
+  _offset(offset)
+{}
+
+std::uint64_t ExternalTMO::for_each(visitor const &visit,
+                                    timeout::flag aborted) const
+{
+  if (visit(_root))
+    return 1u;
+
+  if (_generators.empty() || _root.size() == 0u)
+    return 1u;
+
+  TempFiles files(_directory);
+
+  std::string level(files.create("level"));
+
+  RecordWriter writer(level, _root.size());
+  writer.write(_root.data());
+  writer.close();
+
+  std::vector<std::string> previous_levels;
+
+  std::uint64_t num_visited = 1u;
+
+  for (;;) {
+    auto runs(merge_runs(expand(level, files, aborted), files, aborted));
+
+    std::string next_level(files.create("level"));
+
+    std::vector<std::string> known_levels(previous_levels);
+    known_levels.push_back(level);
+
+    bool stopped = false;
+    std::uint64_t level_size = merge_level(
+      runs, known_levels, next_level, visit, stopped, aborted);
+
+    num_visited += level_size;
+
+    DBG(TRACE) << "Orbit level of size " << level_size << " (" << num_visited
+               << " orbit elements in total)";
+
+    files.remove(runs);
+    files.remove(previous_levels);
+
+    if (stopped || level_size == 0u)
+      return num_visited;
+
+    previous_levels = {level};
+    level = next_level;
+  }
+}
+
+std::vector<std::string> ExternalTMO::expand(std::string const &level,
+                                             TempFiles &files,
+                                             timeout::flag aborted) const
+{
+  unsigned num_tasks = _root.size();
+  unsigned degree = _generators.degree();
+
+  std::size_t max_buffered = std::max(
+    static_cast<std::size_t>(1u),
+    _memory_limit / (num_tasks * sizeof(unsigned)));
+
+  std::vector<unsigned> buffer;
+  std::vector<std::size_t> order;
+
+  std::vector<std::string> runs;
+
+  // write the buffered neighbours as a sorted run without duplicates
+  auto flush = [&]{
+    std::size_t num_buffered = buffer.size() / num_tasks;
+
+    order.resize(num_buffered);
+    std::iota(order.begin(), order.end(), 0u);
+
+    std::sort(order.begin(), order.end(),
+              [&](std::size_t lhs, std::size_t rhs)
+              {
+                return record_less(&buffer[lhs * num_tasks],
+                                   &buffer[rhs * num_tasks],
+                                   num_tasks);
+              });
+
+    runs.push_back(files.create("run"));
+
+    RecordWriter writer(runs.back(), num_tasks);
+
+    unsigned const *last = nullptr;
+    for (std::size_t i : order) {
+      unsigned const *record = &buffer[i * num_tasks];
+
+      if (!last || !record_equal(last, record, num_tasks))
+        writer.write(record);
+
+      last = record;
+    }
+
+    writer.close();
+
+    buffer.clear();
+  };
+
+  for (RecordReader reader(level, num_tasks); reader.valid(); reader.next()) {
+    if (timeout::is_set(aborted))
+      throw timeout::AbortedError("external orbit enumeration");
+
+    unsigned const *record = reader.record();
+
+    for (auto const &gen : _generators) {
+      for (unsigned i = 0u; i < num_tasks; ++i) {
+        unsigned task = record[i];
+
+        if (task >= _offset && task < degree + _offset)
+          task = gen[task - _offset] + _offset;
+
+        buffer.push_back(task);
+      }
+
+      if (buffer.size() / num_tasks >= max_buffered)
+        flush();
+    }
+  }
+
+  if (!buffer.empty())
+    flush();
+
+  return runs;
+}
+
+std::vector<std::string> ExternalTMO::merge_runs(std::vector<std::string> runs,
+                                                 TempFiles &files,
+                                                 timeout::flag aborted) const
+{
+  unsigned num_tasks = _root.size();
+
+  std::vector<unsigned> record;
+
+  while (runs.size() > MAX_MERGE_FAN_IN) {
+    DBG(TRACE) << "Merging " << runs.size() << " sorted runs";
+
+    std::vector<std::string> merged_runs;
+
+    for (std::size_t i = 0u; i < runs.size(); i += MAX_MERGE_FAN_IN) {
+      if (timeout::is_set(aborted))
+        throw timeout::AbortedError("external orbit enumeration");
+
+      std::vector<std::string> group(
+        runs.begin() + i,
+        runs.begin() + std::min(i + MAX_MERGE_FAN_IN, runs.size()));
+
+      merged_runs.push_back(files.create("run"));
+
+      RecordWriter writer(merged_runs.back(), num_tasks);
+
+      RecordMerger merger(group, num_tasks);
+      while (merger.next(record))
+        writer.write(record.data());
+
+      writer.close();
+
+      files.remove(group);
+    }
+
+    runs = merged_runs;
+  }
+
+  return runs;
+}
+
+std::uint64_t ExternalTMO::merge_level(
+  std::vector<std::string> const &runs,
+  std::vector<std::string> const &previous_levels,
+  std::string const &level,
+  visitor const &visit,
+  bool &stopped,
+  timeout::flag aborted) const
+{
+  unsigned num_tasks = _root.size();
+
+  std::vector<std::unique_ptr<RecordReader>> previous;
+  for (auto const &path : previous_levels)
+    previous.emplace_back(new RecordReader(path, num_tasks));
+
+  RecordWriter writer(level, num_tasks);
+  RecordMerger merger(runs, num_tasks);
+
+  std::vector<unsigned> record;
+  std::uint64_t level_size = 0u;
+
+  while (merger.next(record)) {
+    if (timeout::is_set(aborted))
+      throw timeout::AbortedError("external orbit enumeration");
+
+    // neighbours of a level lie in the level itself, the level before it or
+    // the next level
+    bool seen = false;
+    for (auto &reader : previous) {
+      if (reader->seek(record.data()))
+        seen = true;
+    }
+
+    if (seen)
+      continue;
+
+    writer.write(record.data());
+    ++level_size;
+
+    if (visit(TaskMapping(record))) {
+      stopped = true;
+      break;
+    }
+  }
+
+  writer.close();
+
+  return level_size;
+}
+
+} // namespace mpsym
@@ -0,0 +1,397 @@
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "bsgs.hpp"
+#include "orbit.hpp"
+#include "perm_group.hpp"
+#include "perm_set.hpp"
+#include "task_mapping.hpp"
+#include "task_mapping_orbit_generator.hpp"
+#include "timeout.hpp"
+
+namespace
+{
+
+void stabilizer_orbits(unsigned degree,
+                       mpsym::internal::PermSet const &generators,
+                       std::vector<unsigned> &orbit_min,
+                       std::vector<unsigned> &orbit_size)
+{
+  auto generators_with_inverses(generators.with_inverses());
+
+  orbit_min.assign(degree, degree);
+  orbit_size.assign(degree, 0u);
+
+  for (unsigned x = 0u; x < degree; ++x) {
+    if (orbit_min[x] != degree)
+      continue;
+
+    auto orbit(mpsym::internal::Orbit::generate(x, generators_with_inverses));
+
+    for (unsigned y : orbit) {
+      orbit_min[y] = x;
+      orbit_size[y] = orbit.size();
+    }
+  }
+}
+
+} // anonymous namespace
+
+namespace mpsym
+{
+
+using namespace internal;
+
+TMORGenerator::IterationState::IterationState(TMORGenerator const *generator)
+: _generator(generator),
+  _mapping(generator->_prefix.begin(), generator->_prefix.end()),
+  _mapping_count(generator->_degree, 0u)
+{
+  for (unsigned task : _mapping)
+    ++_mapping_count[task];
+
+  if (_generator->_injective && _generator->_num_tasks > _generator->_degree) {
+    _exhausted = true;
+
+  } else if (_mapping.size() == _generator->_num_tasks) {
+    current = TaskMapping(_mapping);
+
+  } else {
+    _frames.push_back({_generator->_prefix_node, 0u});
+    advance();
+  }
+}
+
+void TMORGenerator::IterationState::advance()
+{
+  for (;;) {
+    if (timeout::is_set(_generator->_aborted))
+      throw timeout::AbortedError("orbit representative generation");
+
+    if (_frames.empty()) {
+      _exhausted = true;
+      return;
+    }
+
+    // undo the last choice made on this level
+    if (_mapping.size() == _generator->_prefix.size() + _frames.size()) {
+      --_mapping_count[_mapping.back()];
+      _mapping.pop_back();
+    }
+
+    auto &frame(_frames.back());
+
+    bool found = false;
+    unsigned x = 0u;
+
+    while (frame.next < _generator->_degree) {
+      x = frame.next++;
+
+      if (_generator->_injective && _mapping_count[x] > 0u)
+        continue;
+
+      if (frame.node->is_minimal(x)) {
+        found = true;
+        break;
+      }
+    }
+
+    if (!found) {
+      _frames.pop_back();
+      continue;
+    }
+
+    _mapping.push_back(x);
+    ++_mapping_count[x];
+
+    if (_mapping.size() == _generator->_num_tasks) {
+      current = TaskMapping(_mapping);
+      return;
+    }
+
+    auto node(_generator->child(frame.node, x));
+    _frames.push_back({node, 0u});
+  }
+}
+
+TMORGenerator::TMORGenerator(BSGS const &bsgs,
+                             unsigned num_tasks,
+                             bool injective,
+                             TaskMapping const &prefix,
+                             timeout::flag aborted)
+: _degree(bsgs.degree()),
+  _num_tasks(num_tasks),
+  _injective(injective),
+  _prefix(prefix),
+  _aborted(aborted),
+  _fixed_points_cache(std::make_shared<FixedPointsCache>())
+{
+  if (prefix.size() > num_tasks)
+    throw std::invalid_argument("prefix longer than task mappings");
+
+  auto root(std::make_shared<Node>());
+
+  if (!bsgs.base_empty()) {
+    root->bsgs = std::make_shared<BSGS>(bsgs);
+
+    stabilizer_orbits(_degree,
+                      bsgs.strong_generators(),
+                      root->orbit_min,
+                      root->orbit_size);
+  }
+
+  // the prefix needs to be a representative itself, otherwise there are no
+  // representatives starting with it
+  std::vector<bool> in_prefix(_degree, false);
+
+  _prefix_node = root;
+
+  for (unsigned task : prefix) {
+    if (task >= _degree)
+      throw std::invalid_argument("prefix task out of range");
+
+    if ((injective && in_prefix[task]) || !_prefix_node->is_minimal(task))
+      throw std::invalid_argument("prefix is not an orbit representative");
+
+    if (!in_prefix[task]) {
+      in_prefix[task] = true;
+      ++_prefix_num_distinct_tasks;
+    }
+
+    _prefix_node = child(_prefix_node, task);
+  }
+}
+
+BSGS::order_type TMORGenerator::size() const
+{
+  return count(_prefix_node,
+               _prefix_num_distinct_tasks,
+               _num_tasks - _prefix.size());
+}
+
+BSGS::order_type TMORGenerator::rank(TaskMapping const &representative) const
+{
+  if (representative.size() != _num_tasks)
+    throw std::invalid_argument("representative has wrong number of tasks");
+
+  if (!std::equal(_prefix.begin(), _prefix.end(), representative.begin()))
+    throw std::invalid_argument("representative does not start with prefix");
+
+  std::vector<bool> used(_degree, false);
+  for (unsigned task : _prefix)
+    used[task] = true;
+
+  auto node(_prefix_node);
+  unsigned num_distinct_tasks = _prefix_num_distinct_tasks;
+
+  // count all representatives that branch off to a smaller task before
+  BSGS::order_type rank = 0;
+
+  for (unsigned i = _prefix.size(); i < _num_tasks; ++i) {
+    if (timeout::is_set(_aborted))
+      throw timeout::AbortedError("rank");
+
+    unsigned task = representative[i];
+
+    if (task >= _degree ||
+        (_injective && used[task]) ||
+        !node->is_minimal(task)) {
+      throw std::invalid_argument("mapping is not an orbit representative");
+    }
+
+    for (unsigned x = 0u; x < task; ++x) {
+      if ((_injective && used[x]) || !node->is_minimal(x))
+        continue;
+
+      rank += count(child(node, x),
+                    num_distinct_tasks + (used[x] ? 0u : 1u),
+                    _num_tasks - i - 1u);
+    }
+
+    if (!used[task]) {
+      used[task] = true;
+      ++num_distinct_tasks;
+    }
+
+    node = child(node, task);
+  }
+
+  return rank;
+}
+
+TaskMapping TMORGenerator::unrank(BSGS::order_type rank) const
+{
+  if (rank < 0 || rank >= size())
+    throw std::invalid_argument("rank out of range");
+
+  std::vector<unsigned> representative(_prefix.begin(), _prefix.end());
+
+  std::vector<bool> used(_degree, false);
+  for (unsigned task : _prefix)
+    used[task] = true;
+
+  auto node(_prefix_node);
+  unsigned num_distinct_tasks = _prefix_num_distinct_tasks;
+
+  for (unsigned i = _prefix.size(); i < _num_tasks; ++i) {
+    if (timeout::is_set(_aborted))
+      throw timeout::AbortedError("unrank");
+
+    for (unsigned x = 0u; x < _degree; ++x) {
+      if ((_injective && used[x]) || !node->is_minimal(x))
+        continue;
+
+      auto next(child(node, x));
+      unsigned next_num_distinct_tasks =
+        num_distinct_tasks + (used[x] ? 0u : 1u);
+
+      auto num_reprs(
+        count(next, next_num_distinct_tasks, _num_tasks - i - 1u));
+
+      if (rank < num_reprs) {
+        representative.push_back(x);
+        used[x] = true;
+
+        node = next;
+        num_distinct_tasks = next_num_distinct_tasks;
+        break;
+      }
+
+      rank -= num_reprs;
+    }
+
+    assert(representative.size() == i + 1u);
+  }
+
+  return TaskMapping(representative);
+}
+
+std::shared_ptr<TMORGenerator::Node const> TMORGenerator::child(
+  std::shared_ptr<Node const> const &node,
+  unsigned x) const
+{
+  // the stabilizer of a point it fixes is the stabilizer itself
+  if (node->is_fixed(x))
+    return node;
+
+  auto next(std::make_shared<Node>());
+
+  next->prefix = node->prefix;
+  next->prefix.push_back(x);
+
+  auto bsgs(std::make_shared<BSGS>(*node->bsgs));
+  bsgs->base_change(next->prefix);
+
+  unsigned level = next->prefix.size();
+
+  if (level < bsgs->base_size()) {
+    assert(bsgs->base_point(level - 1u) == x);
+
+    auto generators(bsgs->strong_generators(level));
+
+    if (!generators.empty()) {
+      next->bsgs = bsgs;
+
+      stabilizer_orbits(_degree,
+                        generators,
+                        next->orbit_min,
+                        next->orbit_size);
+    }
+  }
+
+  return next;
+}
+
+BSGS::order_type TMORGenerator::count(std::shared_ptr<Node const> const &node,
+                                      unsigned num_distinct_tasks,
+                                      unsigned num_remaining_tasks) const
+{
+  // by Burnside's lemma applied to the stabilizer of the tasks mapped so far,
+  // an element fixes a completion iff it fixes all processors it uses, if
+  // the mapping is injective these can not be any of the (fixed) processors
+  // already in use
+  auto dist(fixed_points_distribution(node));
+
+  BSGS::order_type order = 0;
+  BSGS::order_type num_fixed_sum = 0;
+
+  for (unsigned i = 0u; i < dist.size(); ++i) {
+    if (dist[i] == 0)
+      continue;
+
+    order += dist[i];
+
+    BSGS::order_type num_fixed = 1;
+
+    if (_injective) {
+      assert(i >= num_distinct_tasks);
+
+      unsigned num_available = i - num_distinct_tasks;
+
+      for (unsigned j = 0u; j < num_remaining_tasks; ++j) {
+        if (j >= num_available) {
+          num_fixed = 0;
+          break;
+        }
+
+        num_fixed *= num_available - j;
+      }
+    } else {
+      num_fixed = boost::multiprecision::pow(BSGS::order_type(i),
+                                             num_remaining_tasks);
+    }
+
+    num_fixed_sum += dist[i] * num_fixed;
+  }
+
+  assert(num_fixed_sum % order == 0);
+
+  return num_fixed_sum / order;
+}
+
+std::vector<BSGS::order_type> TMORGenerator::fixed_points_distribution(
+  std::shared_ptr<Node const> const &node) const
+{
+  if (!node->bsgs) {
+    std::vector<BSGS::order_type> dist(_degree + 1u);
+    dist[_degree] = 1;
+
+    return dist;
+  }
+
+  // the stabilizer only depends on the set of points it stabilizes
+  std::vector<unsigned> key(node->prefix);
+  std::sort(key.begin(), key.end());
+
+  {
+    std::lock_guard<std::mutex> lock(_fixed_points_cache->mutex);
+
+    auto it(_fixed_points_cache->distributions.find(key));
+    if (it != _fixed_points_cache->distributions.end())
+      return it->second;
+  }
+
+  unsigned level = node->prefix.size();
+
+  auto base(node->bsgs->base());
+
+  PermGroup stabilizer(
+    level == 0u ? *node->bsgs
+                : BSGS(_degree,
+                       BSGS::Base(base.begin() + level, base.end()),
+                       node->bsgs->strong_generators(level).with_inverses()));
+
+  auto dist(stabilizer.fixed_points_distribution(_aborted));
+
+  std::lock_guard<std::mutex> lock(_fixed_points_cache->mutex);
+
+  _fixed_points_cache->distributions[key] = dist;
+
+  return dist;
+}
+
+} // namespace mpsym
@@ -0,0 +1,507 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dbg.hpp"
+#include "task_mapping.hpp"
+#include "task_mapping_orbit_mapped.hpp"
+
+namespace
+{
+
+std::uint64_t const LOG_MAGIC = 0x676f6c73726f6d74ull; // "tmorslog"
+std::uint64_t const INDEX_MAGIC = 0x78646973726f6d74ull; // "tmorsidx"
+std::uint64_t const VERSION = 1u;
+
+std::uint64_t const INITIAL_LOG_SIZE = 1u << 20;
+std::uint64_t const INITIAL_INDEX_CAPACITY = 1u << 10;
+
+// orbit indices are stored in and returned as 32 bit integers
+std::uint64_t const MAX_NUM_ORBITS = UINT32_MAX;
+
+struct LogHeader
+{
+  std::uint64_t magic;
+  std::uint64_t version;
+  std::uint64_t end;
+  std::uint64_t num_orbits;
+};
+
+struct IndexHeader
+{
+  std::uint64_t magic;
+  std::uint64_t version;
+  std::uint64_t capacity;
+  std::uint64_t count;
+};
+
+struct IndexSlot
+{
+  std::uint64_t hash;
+  std::uint64_t offset; // zero marks an empty slot
+};
+
+// records consist of the orbit index, the number of tasks and the tasks
+std::uint64_t record_size(std::uint64_t num_tasks)
+{ return (2u + num_tasks) * sizeof(std::uint32_t); }
+
+static_assert(sizeof(unsigned) == sizeof(std::uint32_t),
+              "task mapping records assume 32 bit tasks");
+
+// needs to be stable across processes, std::hash is not guaranteed to be
+std::uint64_t mapping_hash(unsigned const *tasks, std::uint64_t num_tasks)
+{
+  std::uint64_t h = 0xcbf29ce484222325ull ^ num_tasks;
+
+  for (std::uint64_t i = 0u; i < num_tasks; ++i) {
+    h ^= tasks[i];
+    h *= 0x100000001b3ull;
+    h ^= h >> 29;
+  }
+
+  return h;
+}
+
+std::uint64_t mapping_hash(mpsym::TaskMapping const &mapping)
+{ return mapping_hash(mapping.data(), mapping.size()); }
+
+[[noreturn]] void throw_errno(std::string const &what, std::string const &path)
+{
+  throw std::runtime_error(
+    what + " '" + path + "': " + std::strerror(errno));
+}
+
+[[noreturn]] void throw_malformed(std::string const &path)
+{
+  throw std::runtime_error(
+    "malformed task mapping orbit representative log '" + path + "'");
+}
+
+bool file_exists(std::string const &path)
+{
+  struct stat st;
+  return ::stat(path.c_str(), &st) == 0;
+}
+
+} // anonymous namespace
+
+namespace mpsym
+{
+
+struct MappedTMORs::MappedFile
+{
+  MappedFile(std::string const &path_, std::uint64_t min_size)
+  : path(path_)
+  {
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd == -1)
+      throw_errno("failed to open", path);
+
+    struct stat st;
+    if (::fstat(fd, &st) == -1) {
+      ::close(fd);
+      throw_errno("failed to stat", path);
+    }
+
+    created = st.st_size == 0;
+
+    try {
+      map(std::max(static_cast<std::uint64_t>(st.st_size), min_size));
+    } catch (...) {
+      ::close(fd);
+      throw;
+    }
+  }
+
+  ~MappedFile()
+  {
+    if (data)
+      ::munmap(data, size);
+
+    ::close(fd);
+  }
+
+  void map(std::uint64_t new_size)
+  {
+    if (data) {
+      ::munmap(data, size);
+      data = nullptr;
+    }
+
+    if (::ftruncate(fd, static_cast<off_t>(new_size)) == -1)
+      throw_errno("failed to resize", path);
+
+    void *addr = ::mmap(nullptr, new_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                        fd, 0);
+
+    if (addr == MAP_FAILED)
+      throw_errno("failed to map", path);
+
+    data = static_cast<char *>(addr);
+    size = new_size;
+  }
+
+  void sync() const
+  {
+    if (::msync(data, size, MS_SYNC) == -1)
+      throw_errno("failed to sync", path);
+  }
+
+  template<typename T>
+  T *at(std::uint64_t offset) const
+  { return reinterpret_cast<T *>(data + offset); }
+
+  std::string path;
+  int fd = -1;
+  char *data = nullptr;
+  std::uint64_t size = 0u;
+  bool created = false;
+};
+
+MappedTMORs::MappedTMORs(std::string const &path)
+: _path(path)
+{
+  _log.reset(new MappedFile(_path + ".log",
+                            sizeof(LogHeader) + INITIAL_LOG_SIZE));
+
+  auto log_header(_log->at<LogHeader>(0u));
+
+  if (_log->created) {
+    log_header->magic = LOG_MAGIC;
+    log_header->version = VERSION;
+    log_header->end = sizeof(LogHeader);
+    log_header->num_orbits = 0u;
+
+  } else if (log_header->magic != LOG_MAGIC ||
+             log_header->version != VERSION ||
+             log_header->end < sizeof(LogHeader) ||
+             log_header->end > _log->size) {
+    throw_malformed(_log->path);
+  }
+
+  log_validate();
+
+  std::string index_path(_path + ".idx");
+
+  if (file_exists(index_path)) {
+    _index.reset(new MappedFile(index_path, sizeof(IndexHeader)));
+
+    if (index_valid())
+      return;
+
+    DBG(WARN) << "Task mapping orbit representative index '" << index_path
+              << "' is inconsistent with log, rebuilding";
+  }
+
+  index_rebuild();
+}
+
+MappedTMORs::~MappedTMORs()
+{}
+
+std::pair<bool, unsigned> MappedTMORs::insert(TaskMapping const &mapping)
+{
+  std::uint64_t hash = mapping_hash(mapping);
+
+  std::uint64_t offset = find(mapping, hash);
+  if (offset != 0u)
+    return {false, *_log->at<std::uint32_t>(offset)};
+
+  auto index_header(_index->at<IndexHeader>(0u));
+
+  if (2u * (index_header->count + 1u) > index_header->capacity)
+    index_resize(2u * index_header->capacity);
+
+  offset = record_append(mapping);
+  index_insert(hash, offset);
+
+  return {true, *_log->at<std::uint32_t>(offset)};
+}
+
+bool MappedTMORs::is_repr(TaskMapping const &mapping) const
+{ return find(mapping, mapping_hash(mapping)) != 0u; }
+
+unsigned MappedTMORs::num_orbits() const
+{ return static_cast<unsigned>(_log->at<LogHeader>(0u)->num_orbits); }
+
+void MappedTMORs::sync() const
+{
+  _log->sync();
+  _index->sync();
+}
+
+MappedTMORs::const_iterator MappedTMORs::begin() const
+{ return const_iterator(this, sizeof(LogHeader)); }
+
+MappedTMORs::const_iterator MappedTMORs::end() const
+{ return const_iterator(this, _log->at<LogHeader>(0u)->end); }
+
+std::uint64_t MappedTMORs::find(TaskMapping const &mapping,
+                                std::uint64_t hash) const
+{
+  auto index_header(_index->at<IndexHeader>(0u));
+  auto slots(_index->at<IndexSlot>(sizeof(IndexHeader)));
+
+  std::uint64_t mask = index_header->capacity - 1u;
+
+  for (std::uint64_t i = hash & mask;; i = (i + 1u) & mask) {
+    IndexSlot const &slot = slots[i];
+
+    if (slot.offset == 0u)
+      return 0u;
+
+    if (slot.hash == hash && record_equals(slot.offset, mapping))
+      return slot.offset;
+  }
+}
+
+void MappedTMORs::log_validate() const
+{
+  auto log_header(_log->at<LogHeader>(0u));
+
+  // every record has to lie completely within the log and records have to be
+  // numbered consecutively
+  std::uint64_t num_records = 0u;
+
+  for (std::uint64_t offset = sizeof(LogHeader);
+       offset < log_header->end;
+       offset = record_next(offset)) {
+
+    if (record(offset)[0] != num_records)
+      throw_malformed(_log->path);
+
+    ++num_records;
+  }
+
+  if (num_records != log_header->num_orbits ||
+      num_records > MAX_NUM_ORBITS) {
+    throw_malformed(_log->path);
+  }
+}
+
+bool MappedTMORs::index_valid() const
+{
+  auto log_header(_log->at<LogHeader>(0u));
+  auto index_header(_index->at<IndexHeader>(0u));
+
+  if (_index->size < sizeof(IndexHeader) ||
+      index_header->magic != INDEX_MAGIC ||
+      index_header->version != VERSION) {
+    return false;
+  }
+
+  std::uint64_t capacity = index_header->capacity;
+
+  if (capacity == 0u ||
+      (capacity & (capacity - 1u)) != 0u ||
+      capacity > (_index->size - sizeof(IndexHeader)) / sizeof(IndexSlot) ||
+      index_header->count != log_header->num_orbits ||
+      2u * index_header->count > capacity) {
+    return false;
+  }
+
+  // slots are dereferenced without further checks by find
+  auto slots(_index->at<IndexSlot>(sizeof(IndexHeader)));
+
+  std::uint64_t count = 0u;
+
+  for (std::uint64_t i = 0u; i < capacity; ++i) {
+    std::uint64_t offset = slots[i].offset;
+
+    if (offset == 0u)
+      continue;
+
+    if (offset < sizeof(LogHeader) ||
+        offset >= log_header->end ||
+        offset % sizeof(std::uint32_t) != 0u) {
+      return false;
+    }
+
+    ++count;
+  }
+
+  return count == index_header->count;
+}
+
+std::uint64_t MappedTMORs::record_append(TaskMapping const &mapping)
+{
+  auto log_header(_log->at<LogHeader>(0u));
+
+  if (log_header->num_orbits == MAX_NUM_ORBITS) {
+    throw std::runtime_error(
+      "task mapping orbit representative log '" + _log->path + "' is full");
+  }
+
+  std::uint64_t offset = log_header->end;
+  std::uint64_t bytes = record_size(mapping.size());
+
+  if (offset + bytes > _log->size) {
+    _log->map(std::max(2u * _log->size, offset + bytes));
+    log_header = _log->at<LogHeader>(0u);
+  }
+
+  auto record(_log->at<std::uint32_t>(offset));
+
+  record[0] = static_cast<std::uint32_t>(log_header->num_orbits);
+  record[1] = static_cast<std::uint32_t>(mapping.size());
+  std::memcpy(record + 2, mapping.data(), mapping.size() * sizeof(unsigned));
+
+  // only publish the record once it has been written completely
+  log_header->end = offset + bytes;
+  ++log_header->num_orbits;
+
+  return offset;
+}
+
+std::uint32_t const *MappedTMORs::record(std::uint64_t offset) const
+{
+  std::uint64_t end = _log->at<LogHeader>(0u)->end;
+
+  if (offset < sizeof(LogHeader) ||
+      offset % sizeof(std::uint32_t) != 0u ||
+      offset > end ||
+      end - offset < record_size(0u)) {
+    throw_malformed(_log->path);
+  }
+
+  auto record(_log->at<std::uint32_t const>(offset));
+
+  if (end - offset < record_size(record[1]))
+    throw_malformed(_log->path);
+
+  return record;
+}
+
+TaskMapping MappedTMORs::record_mapping(std::uint64_t offset) const
+{
+  auto record(this->record(offset));
+
+  return TaskMapping(std::vector<unsigned>(record + 2, record + 2 + record[1]));
+}
+
+std::uint64_t MappedTMORs::record_next(std::uint64_t offset) const
+{ return offset + record_size(record(offset)[1]); }
+
+bool MappedTMORs::record_equals(std::uint64_t offset,
+                                TaskMapping const &mapping) const
+{
+  auto record(this->record(offset));
+
+  if (record[1] != mapping.size())
+    return false;
+
+  return std::memcmp(record + 2,
+                     mapping.data(),
+                     mapping.size() * sizeof(unsigned)) == 0;
+}
+
+std::unique_ptr<MappedTMORs::MappedFile> MappedTMORs::index_create(
+  std::uint64_t capacity) const
+{
+  std::string index_path_tmp(_path + ".idx.tmp");
+
+  if (std::remove(index_path_tmp.c_str()) != 0 && errno != ENOENT)
+    throw_errno("failed to remove", index_path_tmp);
+
+  std::unique_ptr<MappedFile> index(
+    new MappedFile(index_path_tmp,
+                   sizeof(IndexHeader) + capacity * sizeof(IndexSlot)));
+
+  auto index_header(index->at<IndexHeader>(0u));
+
+  index_header->magic = INDEX_MAGIC;
+  index_header->version = VERSION;
+  index_header->capacity = capacity;
+  index_header->count = 0u;
+
+  return index;
+}
+
+void MappedTMORs::index_insert(std::uint64_t hash, std::uint64_t offset)
+{
+  auto index_header(_index->at<IndexHeader>(0u));
+  auto slots(_index->at<IndexSlot>(sizeof(IndexHeader)));
+
+  std::uint64_t mask = index_header->capacity - 1u;
+
+  std::uint64_t i = hash & mask;
+  while (slots[i].offset != 0u)
+    i = (i + 1u) & mask;
+
+  slots[i].hash = hash;
+  slots[i].offset = offset;
+
+  ++index_header->count;
+}
+
+void MappedTMORs::index_replace(std::unique_ptr<MappedFile> index)
+{
+  std::string index_path(_path + ".idx");
+
+  // atomically replace the old index so that a crash never leaves a
+  // partially written index behind
+  if (std::rename(index->path.c_str(), index_path.c_str()) != 0)
+    throw_errno("failed to rename", index->path);
+
+  index->path = index_path;
+
+  _index = std::move(index);
+}
+
+void MappedTMORs::index_resize(std::uint64_t capacity)
+{
+  DBG(TRACE) << "Resizing task mapping orbit representative index to "
+             << capacity << " slots";
+
+  auto old_index(std::move(_index));
+  _index = index_create(capacity);
+
+  auto slots(old_index->at<IndexSlot>(sizeof(IndexHeader)));
+  std::uint64_t old_capacity = old_index->at<IndexHeader>(0u)->capacity;
+
+  for (std::uint64_t i = 0u; i < old_capacity; ++i) {
+    if (slots[i].offset != 0u)
+      index_insert(slots[i].hash, slots[i].offset);
+  }
+
+  index_replace(std::move(_index));
+}
+
+void MappedTMORs::index_rebuild()
+{
+  std::uint64_t num_orbits = _log->at<LogHeader>(0u)->num_orbits;
+
+  std::uint64_t capacity = INITIAL_INDEX_CAPACITY;
+  while (capacity < 2u * num_orbits)
+    capacity *= 2u;
+
+  DBG(TRACE) << "Rebuilding task mapping orbit representative index with "
+             << capacity << " slots";
+
+  _index = index_create(capacity);
+
+  for (std::uint64_t offset = sizeof(LogHeader);
+       offset < _log->at<LogHeader>(0u)->end;
+       offset = record_next(offset)) {
+
+    auto record(this->record(offset));
+
+    index_insert(mapping_hash(record + 2, record[1]), offset);
+  }
+
+  index_replace(std::move(_index));
+}
+
+} // namespace mpsym
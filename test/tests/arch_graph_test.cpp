@@ -1,6 +1,15 @@
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
 #include <fstream>
 #include <memory>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -8,12 +17,18 @@
 #include "gmock/gmock.h"
 
 #include "arch_graph.hpp"
+#include "arch_graph_automorphisms.hpp"
 #include "arch_graph_cluster.hpp"
 #include "arch_graph_system.hpp"
 #include "arch_uniform_super_graph.hpp"
+#include "bsgs.hpp"
+#include "packed_task_mapping.hpp"
 #include "perm.hpp"
 #include "perm_group.hpp"
+#include "repr_sampler.hpp"
 #include "task_mapping.hpp"
+#include "task_mapping_orbit.hpp"
+#include "task_mapping_orbit_mapped.hpp"
 #include "test_utility.hpp"
 
 #include "test_main.cpp"
@@ -21,6 +36,7 @@
 using namespace mpsym;
 using namespace mpsym::internal;
 
+using testing::Each;
 using testing::UnorderedElementsAreArray;
 
 typedef std::vector<std::vector<unsigned>> orbit;
@@ -372,7 +388,1201 @@ INSTANTIATE_TEST_SUITE_P(
   ArchGraphReprVariantTest,
   testing::Values(ReprOptions::Method::ITERATE,
                   ReprOptions::Method::LOCAL_SEARCH,
-                  ReprOptions::Method::ORBITS));
+                  ReprOptions::Method::ORBITS,
+                  ReprOptions::Method::BACKTRACK));
+
+TEST(ArchGraphAutomorphismsTest, CanCountOrbits)
+{
+  std::vector<PermGroup> groups {
+    PermGroup(6,
+      {
+        Perm(6, {{0, 1, 2, 3, 4, 5}}),
+        Perm(6, {{0, 5}, {1, 4}, {2, 3}})
+      }),
+    PermGroup(8,
+      {
+        Perm(8, {{0, 1}}),
+        Perm(8, {{0, 1, 2}}),
+        Perm(8, {{3, 4, 5, 6}}),
+        Perm(8, {{3, 5}})
+      }),
+    PermGroup(5)
+  };
+
+  for (auto const &group : groups) {
+    ArchGraphAutomorphisms automorphisms(group);
+
+    for (unsigned num_tasks = 1u; num_tasks <= 4u; ++num_tasks) {
+      TMORs orbits, orbits_injective;
+
+      std::vector<unsigned> mapping(num_tasks, 0u);
+
+      for (;;) {
+        TaskMapping representative(automorphisms.repr(mapping));
+
+        orbits.insert(representative);
+
+        std::set<unsigned> pes(mapping.begin(), mapping.end());
+        if (pes.size() == num_tasks)
+          orbits_injective.insert(representative);
+
+        unsigned i = 0u;
+        while (i < num_tasks && ++mapping[i] == group.degree())
+          mapping[i++] = 0u;
+
+        if (i == num_tasks)
+          break;
+      }
+
+      EXPECT_EQ(orbits.num_orbits(), automorphisms.num_orbits(num_tasks))
+        << "Number of orbits of " << num_tasks << " tasks correct.";
+
+      EXPECT_EQ(orbits_injective.num_orbits(),
+                automorphisms.num_orbits(num_tasks, true))
+        << "Number of injective orbits of " << num_tasks << " tasks correct.";
+    }
+  }
+
+  // orbits of three tasks are determined by which tasks are mapped to the
+  // same processor and which of these processors lie in the same block
+  ArchGraphAutomorphisms automorphisms_wreath_product(
+    PermGroup::wreath_product(PermGroup::symmetric(16),
+                              PermGroup::symmetric(4)));
+
+  EXPECT_EQ(12, automorphisms_wreath_product.num_orbits(3u))
+    << "Number of orbits under large wreath product correct.";
+
+  EXPECT_EQ(5, automorphisms_wreath_product.num_orbits(3u, true))
+    << "Number of injective orbits under large wreath product correct.";
+}
+
+TEST(ArchGraphAutomorphismsTest, CanDetermineOrbitSizes)
+{
+  std::vector<PermGroup> groups {
+    PermGroup(6,
+      {
+        Perm(6, {{0, 1, 2, 3, 4, 5}}),
+        Perm(6, {{0, 5}, {1, 4}, {2, 3}})
+      }),
+    PermGroup(8,
+      {
+        Perm(8, {{0, 1}}),
+        Perm(8, {{0, 1, 2}}),
+        Perm(8, {{3, 4, 5, 6}}),
+        Perm(8, {{3, 5}})
+      }),
+    PermGroup(5)
+  };
+
+  for (auto const &group : groups) {
+    ArchGraphAutomorphisms automorphisms(group);
+
+    for (unsigned num_tasks = 1u; num_tasks <= 3u; ++num_tasks) {
+      BSGS::order_type total = 0;
+
+      for (auto const &repr : automorphisms.orbit_reprs(num_tasks)) {
+        auto orbit(automorphisms.automorphisms_orbit(repr));
+
+        unsigned expected = 0u;
+        for (auto it = orbit.begin(); it != orbit.end(); ++it)
+          ++expected;
+
+        auto size(automorphisms.orbit_size(repr));
+
+        EXPECT_EQ(expected, size)
+          << "Size of orbit of " << repr << " correct.";
+
+        total += size;
+      }
+
+      EXPECT_EQ(boost::multiprecision::pow(BSGS::order_type(group.degree()),
+                                           num_tasks),
+                total)
+        << "Orbit sizes sum up to number of mappings.";
+    }
+  }
+
+  // too many possible mappings to enumerate the orbit via perfect hashing
+  ArchGraphAutomorphisms automorphisms_cyclic(PermGroup::cyclic(16));
+
+  TaskMapping mapping_cyclic({0u, 1u, 2u, 3u, 4u, 5u, 6u, 8u});
+  auto orbit_cyclic(automorphisms_cyclic.automorphisms_orbit(mapping_cyclic));
+
+  unsigned orbit_cyclic_size = 0u;
+  for (auto it = orbit_cyclic.begin(); it != orbit_cyclic.end(); ++it)
+    ++orbit_cyclic_size;
+
+  EXPECT_EQ(16u, orbit_cyclic_size)
+    << "Large orbit enumerated correctly.";
+
+  EXPECT_EQ(16u, automorphisms_cyclic.orbit_size(mapping_cyclic))
+    << "Size of large orbit correct.";
+
+  ArchGraphAutomorphisms automorphisms(PermGroup::symmetric(16));
+
+  std::vector<unsigned> mapping(12u);
+  std::iota(mapping.begin(), mapping.end(), 0u);
+
+  BSGS::order_type expected = 1;
+  for (unsigned i = 0u; i < mapping.size(); ++i)
+    expected *= 16u - i;
+
+  EXPECT_EQ(expected, automorphisms.orbit_size(TaskMapping(mapping)))
+    << "Size of large orbit correct.";
+
+  EXPECT_EQ(16u, automorphisms.orbit_size(TaskMapping({0u, 16u})))
+    << "Tasks outside of automorphism domain left fixed.";
+
+  TaskMapping mapping_offset({2u, 3u, 2u, 8u, 1u, 19u});
+
+  std::set<TaskMapping> orbit_offset_expected;
+  for (Perm const &perm : PermGroup::cyclic(16)) {
+    std::vector<unsigned> permuted;
+    for (unsigned task : mapping_offset) {
+      if (task >= 3u && task < 19u)
+        task = perm[task - 3u] + 3u;
+
+      permuted.push_back(task);
+    }
+
+    orbit_offset_expected.insert(TaskMapping(permuted));
+  }
+
+  EXPECT_EQ(orbit_offset_expected.size(),
+            automorphisms_cyclic.orbit_size(mapping_offset, 3u))
+    << "Size of orbit of mapping with offset correct.";
+}
+
+TEST(ArchGraphAutomorphismsTest, CanGenerateReprs)
+{
+  std::vector<PermGroup> groups {
+    PermGroup(6,
+      {
+        Perm(6, {{0, 1, 2, 3, 4, 5}}),
+        Perm(6, {{0, 5}, {1, 4}, {2, 3}})
+      }),
+    PermGroup(8,
+      {
+        Perm(8, {{0, 1}}),
+        Perm(8, {{0, 1, 2}}),
+        Perm(8, {{3, 4, 5, 6}}),
+        Perm(8, {{3, 5}})
+      }),
+    PermGroup(5)
+  };
+
+  for (auto const &group : groups) {
+    ArchGraphAutomorphisms automorphisms(group);
+
+    for (unsigned num_tasks = 0u; num_tasks <= 4u; ++num_tasks) {
+      for (bool injective : {false, true}) {
+        std::vector<TaskMapping> reprs_expected;
+
+        std::vector<unsigned> mapping(num_tasks, 0u);
+
+        for (;;) {
+          std::set<unsigned> pes(mapping.begin(), mapping.end());
+
+          if (!injective || pes.size() == num_tasks) {
+            TaskMapping representative(automorphisms.repr(mapping));
+            if (representative == TaskMapping(mapping))
+              reprs_expected.push_back(representative);
+          }
+
+          unsigned i = num_tasks;
+          while (i > 0u && ++mapping[i - 1u] == group.degree())
+            mapping[--i] = 0u;
+
+          if (i == 0u)
+            break;
+        }
+
+        std::vector<TaskMapping> reprs;
+        for (auto const &repr : automorphisms.orbit_reprs(num_tasks, injective))
+          reprs.push_back(repr);
+
+        EXPECT_EQ(reprs_expected, reprs)
+          << "Representatives of " << num_tasks << " tasks generated correctly"
+          << (injective ? " (injective)." : ".");
+
+        if (num_tasks < 2u)
+          continue;
+
+        std::vector<TaskMapping> reprs_partitioned;
+        for (auto const &prefix : automorphisms.orbit_reprs(2u, injective)) {
+          for (auto const &repr :
+               automorphisms.orbit_reprs(num_tasks, injective, prefix)) {
+            reprs_partitioned.push_back(repr);
+          }
+        }
+
+        EXPECT_EQ(reprs_expected, reprs_partitioned)
+          << "Partitioned representatives of " << num_tasks
+          << " tasks generated correctly"
+          << (injective ? " (injective)." : ".");
+      }
+    }
+  }
+}
+
+TEST(ArchGraphAutomorphismsTest, CanRankReprs)
+{
+  std::vector<PermGroup> groups {
+    PermGroup(6,
+      {
+        Perm(6, {{0, 1, 2, 3, 4, 5}}),
+        Perm(6, {{0, 5}, {1, 4}, {2, 3}})
+      }),
+    PermGroup(8,
+      {
+        Perm(8, {{0, 1}}),
+        Perm(8, {{0, 1, 2}}),
+        Perm(8, {{3, 4, 5, 6}}),
+        Perm(8, {{3, 5}})
+      }),
+    PermGroup(5)
+  };
+
+  for (auto const &group : groups) {
+    ArchGraphAutomorphisms automorphisms(group);
+
+    for (unsigned num_tasks = 1u; num_tasks <= 4u; ++num_tasks) {
+      for (bool injective : {false, true}) {
+        std::vector<TaskMapping> reprs;
+        for (auto const &repr : automorphisms.orbit_reprs(num_tasks, injective))
+          reprs.push_back(repr);
+
+        ASSERT_EQ(reprs.size(), automorphisms.num_orbits(num_tasks, injective))
+          << "Number of representatives correct.";
+
+        for (unsigned i = 0u; i < reprs.size(); ++i) {
+          EXPECT_EQ(i, automorphisms.rank(reprs[i], injective))
+            << "Rank of " << reprs[i] << " correct.";
+
+          EXPECT_EQ(reprs[i], automorphisms.unrank(num_tasks, i, injective))
+            << "Unranking " << i << " correct.";
+        }
+      }
+    }
+  }
+
+  ArchGraphAutomorphisms automorphisms(groups[0]);
+
+  EXPECT_THROW(automorphisms.rank(TaskMapping({0u, 5u, 0u})),
+               std::invalid_argument)
+    << "Can not rank non-representative.";
+
+  EXPECT_THROW(automorphisms.unrank(3u, automorphisms.num_orbits(3u)),
+               std::invalid_argument)
+    << "Can not unrank out of range rank.";
+}
+
+TEST(ArchGraphAutomorphismsTest, CanSampleReprs)
+{
+  ArchGraphAutomorphisms automorphisms(
+    PermGroup(6,
+      {
+        Perm(6, {{0, 1, 2, 3, 4, 5}}),
+        Perm(6, {{0, 5}, {1, 4}, {2, 3}})
+      }));
+
+  unsigned const num_samples = 2000u;
+
+  for (bool injective : {false, true}) {
+    std::vector<TaskMapping> reprs;
+    for (auto const &repr : automorphisms.orbit_reprs(3u, injective))
+      reprs.push_back(repr);
+
+    for (bool weighted : {false, true}) {
+      ReprSampler sampler(automorphisms, 3u, injective, weighted, 42u);
+      ReprSampler sampler_same_seed(automorphisms, 3u, injective, weighted, 42u);
+
+      ASSERT_EQ(reprs.size(), sampler.num_orbits())
+        << "Number of orbits correct.";
+
+      std::unordered_map<TaskMapping, unsigned> counts;
+
+      for (unsigned i = 0u; i < num_samples; ++i) {
+        auto repr(sampler());
+
+        ASSERT_EQ(repr, sampler_same_seed())
+          << "Sampling reproducible for fixed seed.";
+
+        ASSERT_NE(std::find(reprs.begin(), reprs.end(), repr), reprs.end())
+          << "Sampled " << repr << " is orbit representative.";
+
+        ++counts[repr];
+      }
+
+      if (weighted)
+        continue;
+
+      EXPECT_EQ(reprs.size(), counts.size())
+        << "Every orbit sampled.";
+
+      double expected = static_cast<double>(num_samples) / reprs.size();
+
+      for (auto const &count : counts) {
+        EXPECT_GT(count.second, expected / 2.0)
+          << "Orbit of " << count.first << " sampled uniformly.";
+
+        EXPECT_LT(count.second, expected * 2.0)
+          << "Orbit of " << count.first << " sampled uniformly.";
+      }
+    }
+  }
+}
+
+TEST(ArchGraphAutomorphismsTest, CanFindMinimalReprByBacktracking)
+{
+  ArchGraphAutomorphisms automorphisms(
+    PermGroup(9,
+      {
+        Perm(9, {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}}),
+        Perm(9, {{0, 3, 6}, {1, 4, 7}, {2, 5, 8}}),
+        Perm(9, {{0, 1}})
+      }));
+
+  ReprOptions options_iterate;
+  options_iterate.method = ReprOptions::Method::ITERATE;
+  options_iterate.offset = 1u;
+
+  ReprOptions options_backtrack;
+  options_backtrack.method = ReprOptions::Method::BACKTRACK;
+  options_backtrack.offset = 1u;
+
+  for (unsigned i = 0u; i <= 9u; ++i) {
+    for (unsigned j = 0u; j <= 9u; ++j) {
+      for (unsigned k = 0u; k <= 9u; ++k) {
+        TaskMapping mapping({i, j, k});
+
+        EXPECT_EQ(automorphisms.repr(mapping, &options_iterate),
+                  automorphisms.repr(mapping, &options_backtrack))
+          << "Backtracking finds minimal representative of " << mapping;
+      }
+    }
+  }
+}
+
+TEST(ArchGraphAutomorphismsTest, CanFindReprsBatched)
+{
+  ArchGraphAutomorphisms automorphisms(
+    PermGroup(6,
+      {
+        Perm(6, {{0, 1, 2, 3, 4, 5}}),
+        Perm(6, {{0, 5}, {1, 4}, {2, 3}})
+      }));
+
+  std::vector<TaskMapping> mappings;
+  for (unsigned i = 0u; i < 6u; ++i) {
+    for (unsigned j = 0u; j < 6u; ++j) {
+      for (unsigned k = 0u; k < 6u; ++k)
+        mappings.push_back(TaskMapping({i, j, k}));
+    }
+  }
+
+  TMORs orbits_expected;
+  std::vector<std::tuple<TaskMapping, bool, unsigned>> reprs_expected;
+
+  for (auto const &mapping : mappings)
+    reprs_expected.push_back(automorphisms.repr(mapping, orbits_expected));
+
+  for (unsigned num_threads : {1u, 2u, 4u}) {
+    TMORs orbits;
+    auto reprs(automorphisms.repr_batch(mappings, orbits, nullptr, num_threads));
+
+    EXPECT_EQ(reprs_expected, reprs)
+      << "Batched representatives and orbit indices correct "
+      << "(" << num_threads << " threads).";
+
+    EXPECT_EQ(orbits_expected, orbits)
+      << "Batched representatives stored correctly "
+      << "(" << num_threads << " threads).";
+  }
+}
+
+TEST(ArchGraphAutomorphismsTest, CanEnumerateOrbitsInParallel)
+{
+  ArchGraphAutomorphisms automorphisms(
+    PermGroup(8,
+      {
+        Perm(8, {{0, 1}}),
+        Perm(8, {{0, 1, 2}}),
+        Perm(8, {{3, 4, 5, 6, 7}}),
+        Perm(8, {{3, 4}})
+      }));
+
+  std::vector<TaskMapping> mappings {
+    TaskMapping({0u, 3u, 4u, 0u}),
+    TaskMapping({2u, 7u, 1u, 5u, 6u}),
+    TaskMapping({7u, 7u, 7u})
+  };
+
+  for (auto const &mapping : mappings) {
+    std::set<TaskMapping> orbit_expected;
+    for (auto const &m : automorphisms.automorphisms_orbit(mapping))
+      orbit_expected.insert(m);
+
+    ASSERT_EQ(automorphisms.orbit_size(mapping), orbit_expected.size())
+      << "Orbit of " << mapping << " enumerated correctly.";
+
+    for (unsigned num_threads : {2u, 4u}) {
+      std::set<TaskMapping> orbit;
+      for (auto const &m : automorphisms.automorphisms_orbit(mapping,
+                                                             nullptr,
+                                                             num_threads)) {
+        EXPECT_TRUE(orbit.insert(m).second)
+          << "Orbit element " << m << " enumerated only once "
+          << "(" << num_threads << " threads).";
+      }
+
+      EXPECT_EQ(orbit_expected, orbit)
+        << "Orbit of " << mapping << " enumerated correctly "
+        << "(" << num_threads << " threads).";
+    }
+
+    ReprOptions options_backtrack;
+    options_backtrack.method = ReprOptions::Method::BACKTRACK;
+
+    auto repr_expected(automorphisms.repr(mapping, &options_backtrack));
+
+    TMORs orbits;
+    orbits.insert(repr_expected);
+
+    for (unsigned num_threads : {1u, 2u, 4u}) {
+      ReprOptions options;
+      options.method = ReprOptions::Method::ORBITS;
+      options.orbits_num_threads = num_threads;
+
+      EXPECT_EQ(repr_expected, automorphisms.repr(mapping, &options))
+        << "Representative of " << mapping << " found by orbit enumeration "
+        << "(" << num_threads << " threads).";
+
+      EXPECT_EQ(repr_expected,
+                std::get<0>(automorphisms.repr(mapping, orbits, &options)))
+        << "Stored representative of " << mapping << " found by orbit "
+        << "enumeration (" << num_threads << " threads).";
+    }
+  }
+}
+
+TEST(ArchGraphAutomorphismsTest, CanEnumerateOrbitsExternally)
+{
+  ArchGraphAutomorphisms automorphisms(
+    PermGroup(8,
+      {
+        Perm(8, {{0, 1}}),
+        Perm(8, {{0, 1, 2}}),
+        Perm(8, {{3, 4, 5, 6, 7}}),
+        Perm(8, {{3, 4}})
+      }));
+
+  std::vector<TaskMapping> mappings {
+    TaskMapping({0u, 3u, 4u, 0u}),
+    TaskMapping({2u, 7u, 1u, 5u, 6u}),
+    TaskMapping({7u, 7u, 7u})
+  };
+
+  auto directory(testing::TempDir());
+
+  for (auto const &mapping : mappings) {
+    std::set<TaskMapping> orbit_expected;
+    for (auto const &m : automorphisms.automorphisms_orbit(mapping))
+      orbit_expected.insert(m);
+
+    // tiny memory limits force many sorted runs and several merge passes
+    for (std::size_t memory_limit : {1u << 20, 64u, 1u}) {
+      auto orbit_external(automorphisms.automorphisms_orbit_external(
+        mapping, directory, memory_limit));
+
+      std::vector<TaskMapping> orbit;
+      auto num_visited = orbit_external.for_each(
+        [&](TaskMapping const &m){ orbit.push_back(m); return false; });
+
+      EXPECT_EQ(orbit.size(), num_visited)
+        << "Number of visited orbit elements correct.";
+
+      EXPECT_EQ(orbit_expected,
+                std::set<TaskMapping>(orbit.begin(), orbit.end()))
+        << "Orbit of " << mapping << " enumerated correctly "
+        << "(memory limit " << memory_limit << ").";
+
+      EXPECT_EQ(orbit_expected.size(), orbit.size())
+        << "Orbit elements enumerated only once "
+        << "(memory limit " << memory_limit << ").";
+
+      std::vector<TaskMapping> orbit_again;
+      orbit_external.for_each(
+        [&](TaskMapping const &m){ orbit_again.push_back(m); return false; });
+
+      EXPECT_EQ(orbit, orbit_again)
+        << "Orbit enumeration order reproducible.";
+
+      EXPECT_EQ(3u, orbit_external.for_each(
+                      [&](TaskMapping const &m){ return m == orbit[2]; }))
+        << "Can stop orbit enumeration early.";
+    }
+  }
+
+  ArchGraphAutomorphisms automorphisms_symmetric(PermGroup::symmetric(8));
+
+  TaskMapping mapping_symmetric({0u, 1u, 2u, 3u, 4u, 5u, 6u, 7u});
+
+  EXPECT_EQ(automorphisms_symmetric.orbit_size(mapping_symmetric),
+            automorphisms_symmetric.automorphisms_orbit_external(
+              mapping_symmetric, directory, 1u << 12).size())
+    << "Can count large orbit externally.";
+}
+
+TEST(ArchGraphAutomorphismsTest, CanUseReprTable)
+{
+  PermGroup group(6,
+    {
+      Perm(6, {{0, 1, 2, 3, 4, 5}}),
+      Perm(6, {{0, 5}, {1, 4}, {2, 3}})
+    });
+
+  PermGroup group_other(6,
+    {
+      Perm(6, {{0, 1}}),
+      Perm(6, {{2, 3, 4}})
+    });
+
+  ReprOptions options;
+  options.method = ReprOptions::Method::ITERATE;
+
+  auto expect_table_reprs = [&](ArchGraphAutomorphisms &automorphisms,
+                                PermGroup const &group,
+                                std::string const &what)
+  {
+    ArchGraphAutomorphisms automorphisms_expected(group);
+
+    std::set<TaskMapping> reprs;
+
+    for (unsigned i = 0u; i < 6u; ++i) {
+      for (unsigned j = 0u; j < 6u; ++j) {
+        for (unsigned k = 0u; k < 6u; ++k) {
+          TaskMapping mapping({i, j, k});
+
+          auto repr(automorphisms.repr(mapping));
+          reprs.insert(repr);
+
+          EXPECT_EQ(automorphisms_expected.repr(mapping, &options), repr)
+            << "Representative of " << mapping << " correct (" << what << ").";
+        }
+      }
+    }
+
+    EXPECT_EQ(automorphisms_expected.num_orbits(3u), reprs.size())
+      << "Number of orbits correct (" << what << ").";
+  };
+
+  ArchGraphAutomorphisms automorphisms(group);
+
+  for (unsigned num_threads : {1u, 4u}) {
+    automorphisms.enable_repr_table(3u, "", num_threads);
+    ASSERT_TRUE(automorphisms.repr_table_enabled());
+
+    expect_table_reprs(automorphisms, group,
+                       std::to_string(num_threads) + " threads");
+  }
+
+  EXPECT_EQ(TaskMapping({0u, 1u, 2u, 3u}),
+            automorphisms.repr(TaskMapping({0u, 1u, 2u, 3u})))
+    << "Mappings not covered by table handled correctly.";
+
+  automorphisms.disable_repr_table();
+  EXPECT_FALSE(automorphisms.repr_table_enabled());
+
+  auto path(testing::TempDir() + "/mpsym_repr_table_test");
+  std::remove(path.c_str());
+
+  automorphisms.enable_repr_table(3u, path);
+  ASSERT_TRUE(std::ifstream(path).good());
+
+  ArchGraphAutomorphisms automorphisms_loaded(group);
+  automorphisms_loaded.enable_repr_table(3u, path);
+  expect_table_reprs(automorphisms_loaded, group, "loaded");
+
+  ArchGraphAutomorphisms automorphisms_other(group_other);
+  automorphisms_other.enable_repr_table(3u, path);
+  expect_table_reprs(automorphisms_other, group_other, "other architecture");
+
+  std::ofstream(path) << "garbage";
+
+  automorphisms_loaded.enable_repr_table(3u, path);
+  expect_table_reprs(automorphisms_loaded, group, "malformed file");
+
+  std::remove(path.c_str());
+
+  EXPECT_THROW(automorphisms.enable_repr_table(3u, "", 1u, 100u),
+               std::invalid_argument)
+    << "Table size limited.";
+}
+
+TEST(ArchGraphAutomorphismsTest, CanUseElementTable)
+{
+  PermGroup group(9,
+    {
+      Perm(9, {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}}),
+      Perm(9, {{0, 3, 6}, {1, 4, 7}, {2, 5, 8}}),
+      Perm(9, {{0, 1}})
+    });
+
+  ArchGraphAutomorphisms automorphisms(group);
+  ArchGraphAutomorphisms automorphisms_table(group);
+
+  automorphisms_table.enable_element_table(2u);
+  ASSERT_TRUE(automorphisms_table.element_table_enabled());
+
+  ReprOptions options_iterate;
+  options_iterate.method = ReprOptions::Method::ITERATE;
+
+  ReprOptions options_backtrack;
+  options_backtrack.method = ReprOptions::Method::BACKTRACK;
+
+  for (unsigned offset : {0u, 1u}) {
+    options_iterate.offset = offset;
+    options_backtrack.offset = offset;
+
+    TMORs orbits_expected, orbits;
+
+    for (unsigned i = 0u; i <= 9u; ++i) {
+      for (unsigned j = 0u; j <= 9u; ++j) {
+        for (unsigned k = 0u; k <= 9u; ++k) {
+          TaskMapping mapping({i, j, k});
+
+          EXPECT_EQ(automorphisms.repr(mapping, &options_backtrack),
+                    automorphisms_table.repr(mapping, &options_iterate))
+            << "Element table yields minimal representative of " << mapping
+            << " (offset " << offset << ").";
+
+          EXPECT_EQ(automorphisms.repr(mapping,
+                                       orbits_expected,
+                                       &options_iterate),
+                    automorphisms_table.repr(mapping,
+                                             orbits,
+                                             &options_iterate))
+            << "Element table yields correct orbit of " << mapping
+            << " (offset " << offset << ").";
+        }
+      }
+    }
+  }
+
+  automorphisms_table.disable_element_table();
+  EXPECT_FALSE(automorphisms_table.element_table_enabled());
+
+  EXPECT_THROW(automorphisms_table.enable_element_table(1u, 100u),
+               std::invalid_argument)
+    << "Element table size limited.";
+}
+
+TEST(ArchGraphAutomorphismsTest, CanShareReprsBetweenThreads)
+{
+  ArchGraphAutomorphisms automorphisms(
+    PermGroup(6,
+      {
+        Perm(6, {{0, 1, 2, 3, 4, 5}}),
+        Perm(6, {{0, 5}, {1, 4}, {2, 3}})
+      }));
+
+  automorphisms.init_repr();
+
+  std::vector<TaskMapping> mappings;
+  for (unsigned i = 0u; i < 6u; ++i) {
+    for (unsigned j = 0u; j < 6u; ++j) {
+      for (unsigned k = 0u; k < 6u; ++k)
+        mappings.push_back(TaskMapping({i, j, k}));
+    }
+  }
+
+  TMORs orbits_expected;
+  for (auto const &mapping : mappings)
+    automorphisms.repr(mapping, orbits_expected);
+
+  unsigned const num_threads = 4u;
+
+  ConcurrentTMORs orbits(3u);
+  std::vector<std::vector<std::tuple<TaskMapping, bool, unsigned>>>
+    reprs(num_threads);
+
+  std::vector<std::thread> threads;
+  for (unsigned t = 0u; t < num_threads; ++t) {
+    threads.emplace_back([&, t]{
+      for (auto const &mapping : mappings)
+        reprs[t].push_back(automorphisms.repr(mapping, orbits));
+    });
+  }
+
+  for (auto &thread : threads)
+    thread.join();
+
+  ASSERT_EQ(orbits_expected.num_orbits(), orbits.num_orbits())
+    << "Number of orbits correct.";
+
+  auto orbit_reprs(orbits.reprs());
+
+  std::vector<TaskMapping> orbit_reprs_expected;
+  for (auto const &repr : orbits_expected)
+    orbit_reprs_expected.push_back(repr);
+
+  EXPECT_THAT(orbit_reprs, UnorderedElementsAreArray(orbit_reprs_expected))
+    << "Orbit representatives correct.";
+
+  std::vector<unsigned> new_orbits(orbits.num_orbits(), 0u);
+
+  for (unsigned t = 0u; t < num_threads; ++t) {
+    for (auto const &repr : reprs[t]) {
+      unsigned orbit_index = std::get<2>(repr);
+
+      ASSERT_LT(orbit_index, orbit_reprs.size())
+        << "Orbit index in range.";
+
+      EXPECT_EQ(orbit_reprs[orbit_index], std::get<0>(repr))
+        << "Orbit index consistent.";
+
+      if (std::get<1>(repr))
+        ++new_orbits[orbit_index];
+    }
+  }
+
+  EXPECT_THAT(new_orbits, Each(1u))
+    << "Every orbit discovered exactly once.";
+}
+
+TEST(ArchGraphAutomorphismsTest, CanMergeReprs)
+{
+  ArchGraphAutomorphisms automorphisms(
+    PermGroup(6,
+      {
+        Perm(6, {{0, 1, 2, 3, 4, 5}}),
+        Perm(6, {{0, 5}, {1, 4}, {2, 3}})
+      }));
+
+  std::vector<TaskMapping> mappings;
+  for (unsigned i = 0u; i < 6u; ++i) {
+    for (unsigned j = 0u; j < 6u; ++j) {
+      for (unsigned k = 0u; k < 6u; ++k)
+        mappings.push_back(TaskMapping({i, j, k}));
+    }
+  }
+
+  TMORs orbits_expected;
+  for (auto const &mapping : mappings)
+    automorphisms.repr(mapping, orbits_expected);
+
+  unsigned const num_workers = 3u;
+
+  std::vector<TMORs> orbits(num_workers);
+  std::vector<std::vector<std::tuple<TaskMapping, bool, unsigned>>>
+    reprs(num_workers);
+
+  for (unsigned i = 0u; i < mappings.size(); ++i) {
+    unsigned w = (i * 7u) % num_workers;
+    reprs[w].push_back(
+      automorphisms.repr(mappings[mappings.size() - i - 1u], orbits[w]));
+  }
+
+  auto merged(TMORs::merge({&orbits[0], &orbits[1], &orbits[2]}));
+  auto merged_reversed(TMORs::merge({&orbits[2], &orbits[1], &orbits[0]}));
+
+  EXPECT_EQ(orbits_expected, merged.first)
+    << "Merged representatives correct.";
+
+  std::vector<TaskMapping> orbit_reprs(merged.first.num_orbits());
+  for (auto const &repr : merged.first) {
+    auto orbit_index(merged.first.insert(repr).second);
+    orbit_reprs[orbit_index] = repr;
+
+    EXPECT_EQ(orbit_index, merged_reversed.first.insert(repr).second)
+      << "Merged orbit indices independent of input order.";
+  }
+
+  EXPECT_TRUE(std::is_sorted(orbit_reprs.begin(), orbit_reprs.end()))
+    << "Merged orbit indices ordered by representatives.";
+
+  ASSERT_EQ(num_workers, merged.second.size())
+    << "One remapping table per input.";
+
+  for (unsigned w = 0u; w < num_workers; ++w) {
+    for (auto const &repr : reprs[w]) {
+      EXPECT_EQ(orbit_reprs[merged.second[w][std::get<2>(repr)]],
+                std::get<0>(repr))
+        << "Remapped orbit index correct.";
+    }
+  }
+}
+
+TEST(ArchGraphAutomorphismsTest, CanCacheReprs)
+{
+  PermGroup automorphisms(6,
+    {
+      Perm(6, {{0, 1, 2, 3, 4, 5}}),
+      Perm(6, {{0, 5}, {1, 4}, {2, 3}})
+    });
+
+  ArchGraphAutomorphisms ag_expected(automorphisms);
+
+  ArchGraphAutomorphisms ag(automorphisms);
+  ag.enable_repr_cache(2u);
+
+  std::vector<TaskMapping> mappings {
+    {3, 4}, {3, 4}, {5, 1}, {2, 2}, {3, 4}, {2, 2}
+  };
+
+  for (auto const &mapping : mappings) {
+    EXPECT_EQ(ag_expected.repr(mapping), ag.repr(mapping))
+      << "Cached representative of " << mapping << " correct.";
+  }
+
+  EXPECT_EQ(2u, ag.repr_cache_hits())
+    << "Number of cache hits correct.";
+  EXPECT_EQ(4u, ag.repr_cache_misses())
+    << "Number of cache misses correct.";
+
+  ReprOptions options;
+  options.offset = 1u;
+
+  EXPECT_EQ(ag_expected.repr(mappings[0], &options),
+            ag.repr(mappings[0], &options))
+    << "Task offset taken into account by cache.";
+
+  ag.reset_repr();
+  ag.repr(mappings[0]);
+
+  EXPECT_EQ(2u, ag.repr_cache_hits())
+    << "Cache invalidated on reset.";
+}
+
+TEST(ArchGraphAutomorphismsTest, CanUpdateReprIncrementally)
+{
+  ArchGraphAutomorphisms ag(
+    PermGroup(9,
+      {
+        Perm(9, {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}}),
+        Perm(9, {{0, 3, 6}, {1, 4, 7}, {2, 5, 8}}),
+        Perm(9, {{0, 1}})
+      }));
+
+  ReprOptions options;
+  options.method = ReprOptions::Method::ITERATE;
+  options.offset = 1u;
+
+  TaskMapping mapping({5, 0, 9, 5, 2});
+
+  auto incremental(ag.repr_element(mapping, &options));
+
+  ASSERT_EQ(ag.repr(mapping, &options), incremental.representative)
+    << "Representative correct.";
+
+  for (unsigned i = 0u; i < 40u; ++i) {
+    unsigned task = (7u * i) % mapping.size();
+    unsigned pe = (5u * i + 3u) % 10u;
+
+    incremental = ag.repr_update(mapping, incremental, task, pe, &options);
+
+    mapping[task] = pe;
+
+    EXPECT_EQ(ag.repr(mapping, &options), incremental.representative)
+      << "Updated representative of " << mapping << " correct.";
+
+    EXPECT_EQ(incremental.representative,
+              mapping.permuted(incremental.element, options.offset))
+      << "Updated transforming element correct.";
+
+    std::vector<unsigned> processors;
+    for (unsigned task : incremental.representative) {
+      if (task >= 1u && task < 10u &&
+          std::find(processors.begin(), processors.end(), task - 1u) ==
+            processors.end()) {
+        processors.push_back(task - 1u);
+      }
+    }
+
+    auto base(incremental.chain.base());
+
+    EXPECT_TRUE(std::equal(processors.begin(), processors.end(), base.begin()))
+      << "Updated stabilizer chain aligned with representative.";
+  }
+}
+
+TEST(ArchGraphAutomorphismsTest, CanUpdateLargeReprsIncrementally)
+{
+  using clock = std::chrono::steady_clock;
+
+  ArchGraphAutomorphisms ag(
+    PermGroup::wreath_product(PermGroup::symmetric(5),
+                              PermGroup::symmetric(5)));
+
+  ReprOptions options;
+  options.method = ReprOptions::Method::BACKTRACK;
+
+  std::vector<unsigned> tasks;
+  for (unsigned i = 0u; i < 20u; ++i)
+    tasks.push_back((7u * i) % 25u);
+
+  TaskMapping mapping(tasks);
+
+  auto incremental(ag.repr_element(mapping, &options));
+
+  clock::duration update_time(0), recompute_time(0);
+
+  // moving one of the last tasks only re-minimizes the last levels of the
+  // stabilizer chain instead of changing the base from scratch
+  for (unsigned i = 0u; i < 20u; ++i) {
+    unsigned task = 15u + i % 5u;
+    unsigned pe = (11u * i) % 25u;
+
+    auto start(clock::now());
+    incremental = ag.repr_update(mapping, incremental, task, pe, &options);
+    update_time += clock::now() - start;
+
+    mapping[task] = pe;
+
+    start = clock::now();
+    auto recomputed(ag.repr_element(mapping, &options));
+    recompute_time += clock::now() - start;
+
+    EXPECT_EQ(recomputed.representative, incremental.representative)
+      << "Updated representative of " << mapping << " correct.";
+  }
+
+  EXPECT_LT(4 * update_time.count(), recompute_time.count())
+    << "Updating representatives cheaper than recomputing them.";
+}
+
+TEST(ArchGraphAutomorphismsTest, CanStoreReprsOnDisk)
+{
+  ArchGraphAutomorphisms automorphisms(
+    PermGroup(6,
+      {
+        Perm(6, {{0, 1, 2, 3, 4, 5}}),
+        Perm(6, {{0, 5}, {1, 4}, {2, 3}})
+      }));
+
+  auto path(testing::TempDir() + "mpsym_mapped_tmors");
+  std::remove((path + ".log").c_str());
+  std::remove((path + ".idx").c_str());
+
+  std::vector<TaskMapping> mappings;
+  for (unsigned i = 0u; i < 7776u; ++i) {
+    std::vector<unsigned> mapping;
+    for (unsigned j = 0u, k = i; j < 5u; ++j, k /= 6u)
+      mapping.push_back(k % 6u);
+
+    mappings.push_back(TaskMapping(mapping));
+  }
+
+  TMORs orbits_expected;
+  std::vector<std::tuple<TaskMapping, bool, unsigned>> reprs_expected;
+  for (auto const &mapping : mappings)
+    reprs_expected.push_back(automorphisms.repr(mapping, orbits_expected));
+
+  std::vector<TaskMapping> large_mappings;
+  for (unsigned i = 0u; i < 300u; ++i)
+    large_mappings.push_back(TaskMapping(std::vector<unsigned>(1000u, i)));
+
+  {
+    MappedTMORs orbits(path);
+
+    std::vector<std::tuple<TaskMapping, bool, unsigned>> reprs;
+    for (auto const &mapping : mappings)
+      reprs.push_back(automorphisms.repr(mapping, orbits));
+
+    EXPECT_EQ(reprs_expected, reprs)
+      << "Representatives and orbit indices correct.";
+  }
+
+  {
+    MappedTMORs orbits(path);
+
+    ASSERT_EQ(orbits_expected.num_orbits(), orbits.num_orbits())
+      << "Number of orbits correct after reopening.";
+
+    for (auto const &mapping : mappings) {
+      auto repr(automorphisms.repr(mapping, orbits));
+
+      EXPECT_FALSE(std::get<1>(repr))
+        << "No new orbits discovered after reopening.";
+    }
+
+    for (auto const &mapping : large_mappings)
+      orbits.insert(mapping);
+  }
+
+  std::remove((path + ".idx").c_str());
+
+  MappedTMORs orbits(path);
+
+  EXPECT_EQ(orbits_expected.num_orbits() + large_mappings.size(),
+            orbits.num_orbits())
+    << "Number of orbits correct after rebuilding index.";
+
+  for (auto const &mapping : large_mappings) {
+    EXPECT_TRUE(orbits.is_repr(mapping))
+      << "Can look up representative after rebuilding index.";
+  }
+
+  std::vector<TaskMapping> orbit_reprs, orbit_reprs_expected;
+
+  for (auto const &repr : orbits)
+    orbit_reprs.push_back(repr);
+
+  for (auto const &repr : orbits_expected)
+    orbit_reprs_expected.push_back(repr);
+
+  orbit_reprs_expected.insert(orbit_reprs_expected.end(),
+                              large_mappings.begin(),
+                              large_mappings.end());
+
+  EXPECT_THAT(orbit_reprs, UnorderedElementsAreArray(orbit_reprs_expected))
+    << "Can iterate over stored representatives.";
+}
+
+TEST(ArchGraphAutomorphismsTest, DetectsCorruptedReprsOnDisk)
+{
+  auto path(testing::TempDir() + "mpsym_mapped_tmors_corrupted");
+  std::remove((path + ".log").c_str());
+  std::remove((path + ".idx").c_str());
+
+  std::vector<TaskMapping> mappings {
+    TaskMapping({0u, 1u, 2u}),
+    TaskMapping({2u, 1u, 0u}),
+    TaskMapping({1u, 1u, 1u, 1u})
+  };
+
+  {
+    MappedTMORs orbits(path);
+
+    for (auto const &mapping : mappings)
+      orbits.insert(mapping);
+  }
+
+  // headers consist of four 64 bit fields, index slots of two
+  {
+    std::fstream index(path + ".idx",
+                       std::ios::in | std::ios::out | std::ios::binary);
+
+    std::uint64_t capacity;
+    index.seekg(2u * sizeof(std::uint64_t));
+    index.read(reinterpret_cast<char *>(&capacity), sizeof(capacity));
+
+    for (std::uint64_t i = 0u; i < capacity; ++i) {
+      std::streamoff slot_offset = (5u + 2u * i) * sizeof(std::uint64_t);
+
+      std::uint64_t offset;
+      index.seekg(slot_offset);
+      index.read(reinterpret_cast<char *>(&offset), sizeof(offset));
+
+      if (offset == 0u)
+        continue;
+
+      offset = 1ull << 40;
+      index.seekp(slot_offset);
+      index.write(reinterpret_cast<char *>(&offset), sizeof(offset));
+    }
+
+    ASSERT_TRUE(index.good());
+  }
+
+  {
+    MappedTMORs orbits(path);
+
+    for (auto const &mapping : mappings) {
+      EXPECT_TRUE(orbits.is_repr(mapping))
+        << "Index pointing past the end of the log is rebuilt.";
+    }
+  }
+
+  // make the first record extend past the end of the log
+  {
+    std::fstream log(path + ".log",
+                     std::ios::in | std::ios::out | std::ios::binary);
+
+    std::uint32_t num_tasks = 1u << 30;
+    log.seekp(4u * sizeof(std::uint64_t) + sizeof(std::uint32_t));
+    log.write(reinterpret_cast<char *>(&num_tasks), sizeof(num_tasks));
+
+    ASSERT_TRUE(log.good());
+  }
+
+  EXPECT_THROW(MappedTMORs orbits(path), std::runtime_error)
+    << "Log containing truncated record is rejected.";
+}
+
+TEST(PackedTaskMappingTest, CanPackTaskMappings)
+{
+  std::vector<TaskMapping> mappings {
+    TaskMapping(std::vector<unsigned>()),
+    TaskMapping({0u}),
+    TaskMapping({0u, 1u, 1u, 0u}),
+    TaskMapping({0u, 1u, 1u, 0u, 0u}),
+    TaskMapping({7u, 3u, 5u}),
+    TaskMapping({0xffffffffu, 0u, 42u})
+  };
+
+  std::vector<unsigned> large;
+  for (unsigned i = 0u; i < 100u; ++i)
+    large.push_back((i * 37u) % 1000u);
+
+  mappings.push_back(TaskMapping(large));
+
+  for (auto const &mapping : mappings) {
+    PackedTaskMapping packed(mapping);
+
+    EXPECT_EQ(mapping, packed.unpack())
+      << "Unpacking packed task mapping " << mapping << " correct.";
+
+    EXPECT_EQ(mapping.size(), packed.size())
+      << "Size of packed task mapping " << mapping << " correct.";
+
+    PackedTaskMapping copied(packed);
+    PackedTaskMapping moved(std::move(copied));
+
+    PackedTaskMapping assigned;
+    assigned = moved;
+
+    EXPECT_TRUE(moved == packed && assigned == packed)
+      << "Copying and moving packed task mapping " << mapping << " correct.";
+  }
+
+  EXPECT_LE(sizeof(PackedTaskMapping), 24u)
+    << "Packed task mappings stored compactly.";
+
+  for (std::size_t i = 0u; i < mappings.size(); ++i) {
+    for (std::size_t j = 0u; j < mappings.size(); ++j) {
+      PackedTaskMapping lhs(mappings[i]), rhs(mappings[j]);
+
+      if (i == j) {
+        EXPECT_TRUE(lhs == rhs && lhs.hash() == rhs.hash())
+          << "Packed task mapping " << mappings[i] << " equal to itself.";
+      } else {
+        EXPECT_TRUE(lhs != rhs)
+          << "Packed task mappings " << mappings[i] << " and "
+          << mappings[j] << " differ.";
+      }
+    }
+  }
+
+  TMORs orbits;
+  for (auto const &mapping : mappings) {
+    EXPECT_TRUE(orbits.insert(mapping).first)
+      << "Can insert task mapping " << mapping << " into packed orbit set.";
+  }
+
+  for (auto const &mapping : mappings) {
+    EXPECT_TRUE(orbits.is_repr(mapping))
+      << "Can look up task mapping " << mapping << " in packed orbit set.";
+  }
+
+  std::vector<TaskMapping> reprs;
+  for (auto const &repr : orbits)
+    reprs.push_back(repr);
+
+  EXPECT_THAT(reprs, UnorderedElementsAreArray(mappings))
+    << "Can iterate over packed orbit set.";
+}
 
 template<typename T>
 class ArchGraphClusterTestBase : public T
@@ -440,6 +1650,118 @@ TEST_F(ArchGraphClusterTest, CanObtainAutormorphisms)
     << "Automorphisms of minimal architecture graph cluster correct.";
 }
 
+TEST_F(ArchGraphClusterTest, CanDetermineReprsConcurrently)
+{
+  std::vector<TaskMapping> mappings;
+  for (unsigned i = 0u; i < 4u; ++i) {
+    for (unsigned j = 0u; j < 4u; ++j)
+      mappings.push_back(TaskMapping({i, j}));
+  }
+
+  unsigned const num_threads = 4u;
+
+  std::vector<std::vector<TaskMapping>> reprs(num_threads);
+
+  // automorphisms are initialized lazily by whichever thread comes first
+  std::vector<std::thread> threads;
+  for (unsigned t = 0u; t < num_threads; ++t) {
+    threads.emplace_back([&, t]{
+      for (auto const &mapping : mappings)
+        reprs[t].push_back(cluster_minimal->repr(mapping));
+    });
+  }
+
+  for (auto &thread : threads)
+    thread.join();
+
+  for (unsigned t = 0u; t < num_threads; ++t) {
+    for (auto i = 0u; i < mappings.size(); ++i) {
+      EXPECT_EQ(cluster_minimal->repr(mappings[i]), reprs[t][i])
+        << "Representative of " << mappings[i] << " correct "
+        << "(thread " << t << ").";
+    }
+  }
+}
+
+TEST_F(ArchGraphClusterTest, CanSampleReprs)
+{
+  for (bool injective : {false, true}) {
+    std::vector<TaskMapping> reprs;
+    for (auto const &repr : cluster_minimal->orbit_reprs(3u, injective))
+      reprs.push_back(repr);
+
+    for (bool weighted : {false, true}) {
+      ReprSampler sampler(*cluster_minimal, 3u, injective, weighted, 42u);
+
+      for (unsigned i = 0u; i < 200u; ++i) {
+        auto repr(sampler());
+
+        ASSERT_NE(std::find(reprs.begin(), reprs.end(), repr), reprs.end())
+          << "Sampled " << repr << " is orbit representative"
+          << (weighted ? " (weighted)." : ".");
+      }
+    }
+  }
+}
+
+TEST_F(ArchGraphClusterTest, CanUseReprTable)
+{
+  std::vector<TaskMapping> mappings, reprs;
+  for (unsigned i = 0u; i < 4u; ++i) {
+    for (unsigned j = 0u; j < 4u; ++j) {
+      mappings.push_back(TaskMapping({i, j}));
+      reprs.push_back(cluster_minimal->repr(mappings.back()));
+    }
+  }
+
+  cluster_minimal->enable_repr_table(2u);
+  ASSERT_TRUE(cluster_minimal->repr_table_enabled());
+
+  for (auto const &subsystem : cluster_minimal->subsystems()) {
+    EXPECT_TRUE(subsystem->repr_table_enabled())
+      << "Representative table enabled for subsystems.";
+  }
+
+  for (auto i = 0u; i < mappings.size(); ++i) {
+    EXPECT_EQ(reprs[i], cluster_minimal->repr(mappings[i]))
+      << "Representative table yields representative of " << mappings[i]
+      << ".";
+  }
+
+  cluster_minimal->disable_repr_table();
+  EXPECT_FALSE(cluster_minimal->repr_table_enabled());
+}
+
+TEST_F(ArchGraphClusterTest, CanUseElementTable)
+{
+  ReprOptions options;
+  options.method = ReprOptions::Method::ITERATE;
+
+  std::vector<TaskMapping> mappings, reprs;
+  for (unsigned i = 0u; i < 4u; ++i) {
+    for (unsigned j = 0u; j < 4u; ++j) {
+      mappings.push_back(TaskMapping({i, j}));
+      reprs.push_back(cluster_minimal->repr(mappings.back(), &options));
+    }
+  }
+
+  cluster_minimal->enable_element_table();
+  ASSERT_TRUE(cluster_minimal->element_table_enabled());
+
+  for (auto const &subsystem : cluster_minimal->subsystems()) {
+    EXPECT_TRUE(subsystem->element_table_enabled())
+      << "Element table enabled for subsystems.";
+  }
+
+  for (auto i = 0u; i < mappings.size(); ++i) {
+    EXPECT_EQ(reprs[i], cluster_minimal->repr(mappings[i], &options))
+      << "Element table yields representative of " << mappings[i] << ".";
+  }
+
+  cluster_minimal->disable_element_table();
+  EXPECT_FALSE(cluster_minimal->element_table_enabled());
+}
+
 class ArchGraphClusterReprVariantTest :
   public ArchGraphClusterTestBase<testing::TestWithParam<ReprOptions::Method>>
 {};
@@ -468,7 +1790,8 @@ INSTANTIATE_TEST_SUITE_P(
   ArchGraphClusterReprVariantTest,
   testing::Values(ReprOptions::Method::ITERATE,
                   ReprOptions::Method::LOCAL_SEARCH,
-                  ReprOptions::Method::ORBITS));
+                  ReprOptions::Method::ORBITS,
+                  ReprOptions::Method::BACKTRACK));
 
 template<typename T>
 class ArchUniformSuperGraphTestBase : public T
@@ -552,3 +1875,98 @@ TEST_F(ArchUniformSuperGraphTest, CanObtainAutormorphisms)
   EXPECT_EQ(expected_automorphisms, super_graph_minimal->automorphisms())
     << "Automorphisms of uniform architecture super_graph correct.";
 }
+
+TEST_F(ArchUniformSuperGraphTest, CanSampleReprs)
+{
+  for (bool injective : {false, true}) {
+    std::vector<TaskMapping> reprs;
+    for (auto const &repr : super_graph_minimal->orbit_reprs(3u, injective))
+      reprs.push_back(repr);
+
+    for (bool weighted : {false, true}) {
+      ReprSampler sampler(*super_graph_minimal, 3u, injective, weighted, 42u);
+
+      for (unsigned i = 0u; i < 200u; ++i) {
+        auto repr(sampler());
+
+        ASSERT_NE(std::find(reprs.begin(), reprs.end(), repr), reprs.end())
+          << "Sampled " << repr << " is orbit representative"
+          << (weighted ? " (weighted)." : ".");
+      }
+    }
+  }
+}
+
+TEST_F(ArchUniformSuperGraphTest, CanUseReprTable)
+{
+  std::vector<TaskMapping> mappings, reprs;
+  for (unsigned i = 0u; i < 12u; ++i) {
+    for (unsigned j = 0u; j < 12u; ++j) {
+      for (unsigned k = 0u; k < 12u; ++k) {
+        mappings.push_back(TaskMapping({i, j, k}));
+        reprs.push_back(super_graph_minimal->repr(mappings.back()));
+      }
+    }
+  }
+
+  auto path(testing::TempDir() + "/mpsym_super_graph_repr_table_test");
+
+  super_graph_minimal->enable_repr_table(3u, path, 2u);
+  ASSERT_TRUE(super_graph_minimal->repr_table_enabled());
+
+  EXPECT_TRUE(std::ifstream(path + ".0").good())
+    << "Representative tables of subsystem groups saved.";
+
+  for (auto i = 0u; i < mappings.size(); ++i) {
+    EXPECT_EQ(reprs[i], super_graph_minimal->repr(mappings[i]))
+      << "Representative table yields representative of " << mappings[i]
+      << ".";
+  }
+
+  TMORs orbits, orbits_table;
+  for (auto const &mapping : mappings)
+    super_graph_minimal->repr(mapping, orbits_table);
+
+  super_graph_minimal->disable_repr_table();
+  EXPECT_FALSE(super_graph_minimal->repr_table_enabled());
+
+  for (auto const &mapping : mappings)
+    super_graph_minimal->repr(mapping, orbits);
+
+  EXPECT_EQ(orbits.num_orbits(), orbits_table.num_orbits())
+    << "Representative table does not change number of orbits.";
+
+  for (unsigned i = 0u; i < 5u; ++i)
+    std::remove((path + "." + std::to_string(i)).c_str());
+}
+
+TEST_F(ArchUniformSuperGraphTest, CanUseElementTable)
+{
+  ReprOptions options;
+  options.method = ReprOptions::Method::ITERATE;
+
+  std::vector<TaskMapping> mappings, reprs;
+  for (unsigned i = 0u; i < 12u; ++i) {
+    for (unsigned j = 0u; j < 12u; ++j) {
+      for (unsigned k = 0u; k < 12u; ++k) {
+        mappings.push_back(TaskMapping({i, j, k}));
+        reprs.push_back(super_graph_minimal->repr(mappings.back(), &options));
+      }
+    }
+  }
+
+  super_graph_minimal->enable_element_table(2u);
+  ASSERT_TRUE(super_graph_minimal->element_table_enabled());
+
+  for (auto i = 0u; i < mappings.size(); ++i) {
+    EXPECT_EQ(reprs[i], super_graph_minimal->repr(mappings[i], &options))
+      << "Element table yields representative of " << mappings[i] << ".";
+  }
+
+  super_graph_minimal->disable_element_table();
+  EXPECT_FALSE(super_graph_minimal->element_table_enabled());
+
+  EXPECT_THROW(super_graph_minimal->enable_element_table(1u, 5u),
+               std::invalid_argument)
+    << "Element table size limited.";
+}
@@ -1,42 +1,55 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
 #include <memory>
+#include <string>
+#include <thread>
+#include <unordered_set>
 #include <vector>
 
 #include "gmock/gmock.h"
 
 #include "bsgs.hpp"
+#include "orbit.hpp"
 #include "perm.hpp"
 #include "perm_group.hpp"
 #include "perm_set.hpp"
+#include "test_utility.hpp"
+#include "timeout.hpp"
 
 #include "test_main.cpp"
 
 using namespace mpsym;
 using namespace mpsym::internal;
 
-TEST(DISABLED_BSGSSolveTest, CanSolveBSGS)
+TEST(BSGSSolveTest, CanSolveBSGS)
 {
   BSGSOptions bsgs_options;
   bsgs_options.construction = BSGSOptions::Construction::SOLVE;
 
   PermSet generators_solvable {
-    Perm(4, {{2, 4}}),
-    Perm(4, {{1, 2}, {3, 4}})
+    Perm(4, {{1, 3}}),
+    Perm(4, {{0, 1}, {2, 3}})
   };
 
   Perm generators_solvable_expected_elements[] = {
-    Perm(4, {{1, 2, 3, 4}}),
-    Perm(4, {{1, 2}, {3, 4}}),
-    Perm(4, {{1, 3}, {2, 4}}),
-    Perm(4, {{1, 3}}),
-    Perm(4, {{1, 4, 3, 2}}),
-    Perm(4, {{1, 4}, {2, 3}}),
-    Perm(4, {{2, 4}})
+    Perm(4, {{0, 1, 2, 3}}),
+    Perm(4, {{0, 1}, {2, 3}}),
+    Perm(4, {{0, 2}, {1, 3}}),
+    Perm(4, {{0, 2}}),
+    Perm(4, {{0, 3, 2, 1}}),
+    Perm(4, {{0, 3}, {1, 2}}),
+    Perm(4, {{1, 3}})
   };
 
   PermSet generators_non_solvable(PermGroup::symmetric(5).generators());
 
   BSGS bsgs(4, generators_solvable, &bsgs_options);
 
+  EXPECT_EQ(8, bsgs.order())
+    << "Solvable group BSGS has correct order.";
+
   for (Perm const &perm : generators_solvable_expected_elements) {
     EXPECT_TRUE(bsgs.strips_completely(perm))
       << "Solvable group BSGS correct.";
@@ -47,6 +60,269 @@ TEST(DISABLED_BSGSSolveTest, CanSolveBSGS)
       << "Solving BSGS fails for non-solvable group generating set.";
 }
 
+TEST(BSGSSolveTest, CanObtainPolycyclicGeneratingSequence)
+{
+  BSGSOptions bsgs_options;
+  bsgs_options.construction = BSGSOptions::Construction::SOLVE;
+
+  PermSet generators[] = {
+    {
+      Perm(4, {{1, 3}}),
+      Perm(4, {{0, 1}, {2, 3}})
+    },
+    {
+      Perm(4, {{0, 1}}),
+      Perm(4, {{0, 1, 2, 3}})
+    },
+    {
+      Perm(6, {{0, 1, 2}}),
+      Perm(6, {{0, 3}, {1, 4}, {2, 5}}),
+      Perm(6, {{3, 4}})
+    },
+    {
+      Perm(8, {{0, 1}, {2, 3}, {4, 5}, {6, 7}}),
+      Perm(8, {{0, 2, 4, 6}, {1, 3, 5, 7}}),
+      Perm(8, {{0, 4}})
+    }
+  };
+
+  for (auto const &gens : generators) {
+    PermGroup pg(BSGS(gens, &bsgs_options));
+    PermGroup pg_expected(gens.degree(), gens);
+
+    ASSERT_TRUE(pg.has_pcgs())
+      << "Solving BSGS yields polycyclic generating sequence.";
+
+    EXPECT_EQ(pg_expected.order(), pg.order())
+      << "Solved BSGS has correct order.";
+
+    auto relative_orders(pg.pcgs_relative_orders());
+
+    ASSERT_EQ(pg.pcgs().size(), relative_orders.size())
+      << "Relative order known for each polycyclic generator.";
+
+    BSGS::order_type relative_orders_product = 1;
+    for (unsigned m : relative_orders)
+      relative_orders_product *= m;
+
+    EXPECT_EQ(pg.order(), relative_orders_product)
+      << "Relative orders multiply to group order.";
+
+    std::unordered_set<Perm> elements;
+
+    std::vector<unsigned> exponents(relative_orders.size(), 0u);
+    for (;;) {
+      Perm perm(pg.pcgs_element(exponents));
+
+      EXPECT_TRUE(pg_expected.contains_element(perm))
+        << "Exponent vector maps to group element.";
+
+      elements.insert(perm);
+
+      unsigned i = 0u;
+      while (i < exponents.size() && ++exponents[i] == relative_orders[i])
+        exponents[i++] = 0u;
+
+      if (i == exponents.size())
+        break;
+    }
+
+    EXPECT_EQ(pg.order(), elements.size())
+      << "Exponent vectors map to distinct group elements.";
+
+    EXPECT_TRUE(perm_group_equal(pg_expected, pg))
+      << "Iterating over solvable group yields correct elements.";
+  }
+}
+
+TEST(BSGSBaseChangeTest, CanChangeBase)
+{
+  PermGroup pg(6, {
+    Perm(6, {{0, 1, 2}}),
+    Perm(6, {{0, 3}, {1, 4}, {2, 5}}),
+    Perm(6, {{3, 4}})
+  });
+
+  std::vector<std::vector<unsigned>> prefixes {
+    {5},
+    {4, 1},
+    {2, 5, 0},
+    {3, 4, 5, 0, 1}
+  };
+
+  for (auto const &prefix : prefixes) {
+    BSGS bsgs(pg.bsgs());
+    bsgs.base_change(prefix);
+
+    auto base(bsgs.base());
+
+    EXPECT_TRUE(std::equal(prefix.begin(), prefix.end(), base.begin()))
+      << "Base change results in correct base prefix.";
+
+    EXPECT_EQ(pg.order(), bsgs.order())
+      << "Base change preserves group order.";
+
+    BSGS::order_type orbit_size_product = 1;
+    for (unsigned i = 0u; i < bsgs.base_size(); ++i) {
+      EXPECT_EQ(bsgs.orbit(i).size(), bsgs.orbit_size(i))
+        << "Cached fundamental orbit sizes correct after base change.";
+
+      orbit_size_product *= bsgs.orbit_size(i);
+    }
+
+    EXPECT_EQ(pg.order(), orbit_size_product)
+      << "Fundamental orbit sizes consistent with group order.";
+
+    for (unsigned i = 0u; i <= bsgs.base_size(); ++i) {
+      std::vector<Perm> expected_strong_generators;
+      for (Perm const &sg : bsgs.strong_generators()) {
+        if (sg.stabilizes(base.begin(), base.begin() + i))
+          expected_strong_generators.push_back(sg);
+      }
+
+      auto strong_generators(bsgs.strong_generators(i));
+
+      EXPECT_EQ(expected_strong_generators,
+                std::vector<Perm>(strong_generators.begin(),
+                                  strong_generators.end()))
+        << "Per-level strong generators correct after base change.";
+    }
+
+    for (Perm const &perm : pg) {
+      EXPECT_TRUE(bsgs.strips_completely(perm))
+        << "Group elements strip completely after base change.";
+    }
+  }
+}
+
+TEST(BSGSBaseChangeTest, CopiesCanShareSchreierStructures)
+{
+  PermSet generators {
+    Perm(9, {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}}),
+    Perm(9, {{0, 3, 6}, {1, 4, 7}, {2, 5, 8}}),
+    Perm(9, {{0, 1}})
+  };
+
+  // small enough that levels are not all materialized at once
+  BSGSOptions options;
+  options.transversals = BSGSOptions::Transversals::HYBRID;
+  options.hybrid_transversals_budget = 1u << 12;
+
+  BSGS bsgs(generators.degree(), generators, &options);
+  auto base(bsgs.base());
+
+  BSGS bsgs_copy(bsgs);
+  bsgs_copy.base_change({8, 7});
+
+  EXPECT_EQ(base, bsgs.base())
+    << "Base change of copy does not affect original.";
+
+  PermGroup pg(bsgs);
+  auto s9(PermGroup::symmetric(9));
+
+  std::vector<Perm> candidates;
+  for (unsigned i = 0u; i < 500u; ++i) {
+    candidates.push_back(s9.random_element());
+    candidates.push_back(pg.random_element());
+  }
+
+  std::vector<bool> expected;
+  for (Perm const &perm : candidates)
+    expected.push_back(bsgs.strips_completely(perm));
+
+  std::vector<bool> stripped, stripped_copy;
+
+  std::thread strip_thread([&]{
+    for (Perm const &perm : candidates)
+      stripped.push_back(bsgs.strips_completely(perm));
+  });
+
+  for (Perm const &perm : candidates)
+    stripped_copy.push_back(bsgs_copy.strips_completely(perm));
+
+  strip_thread.join();
+
+  EXPECT_EQ(expected, stripped)
+    << "Original can be used concurrently with copy.";
+
+  EXPECT_EQ(expected, stripped_copy)
+    << "Copy can be used concurrently with original.";
+}
+
+TEST(BSGSCheckpointTest, CanResumeSchreierSims)
+{
+  PermSet generators {
+    Perm(12, {{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10}}),
+    Perm(12, {{2, 6, 10, 7}, {3, 9, 4, 5}}),
+    Perm(12, {{0, 11}, {1, 10}, {2, 5}, {3, 7}, {4, 8}, {6, 9}})
+  };
+
+  BSGSOptions bsgs_options;
+  bsgs_options.construction = BSGSOptions::Construction::SCHREIER_SIMS;
+  bsgs_options.check_sym = false;
+
+  BSGS bsgs_expected(generators, &bsgs_options);
+
+  auto checkpoint_file(testing::TempDir() + "mpsym_bsgs_checkpoint");
+  std::remove(checkpoint_file.c_str());
+
+  bsgs_options.schreier_sims_checkpoint_file = checkpoint_file;
+  bsgs_options.schreier_sims_checkpoint_resume = true;
+
+  auto expect_bsgs_equal = [&](BSGS const &bsgs) {
+    EXPECT_EQ(bsgs_expected.base(), bsgs.base())
+      << "Resumed Schreier Sims yields same base.";
+
+    auto sgs_expected(bsgs_expected.strong_generators());
+    auto sgs(bsgs.strong_generators());
+
+    EXPECT_EQ(std::vector<Perm>(sgs_expected.begin(), sgs_expected.end()),
+              std::vector<Perm>(sgs.begin(), sgs.end()))
+      << "Resumed Schreier Sims yields same strong generating set.";
+
+    EXPECT_EQ(bsgs_expected.order(), bsgs.order())
+      << "Resumed Schreier Sims yields correct order.";
+
+    EXPECT_FALSE(std::ifstream(checkpoint_file))
+      << "Checkpoint removed after completion.";
+  };
+
+  // abort immediately
+  auto aborted(timeout::unset());
+  timeout::set(aborted);
+
+  EXPECT_THROW(BSGS dummy(generators, &bsgs_options, aborted),
+               timeout::AbortedError)
+    << "Schreier Sims aborted.";
+
+  EXPECT_TRUE(std::ifstream(checkpoint_file))
+    << "Checkpoint written on abort.";
+
+  expect_bsgs_equal(BSGS(generators, &bsgs_options));
+
+  // abort after some progress has been made
+  for (auto delay = 1u;; delay *= 2u) {
+    auto aborted_delayed(timeout::unset());
+
+    std::thread abort_thread([&]{
+      std::this_thread::sleep_for(std::chrono::microseconds(delay));
+      timeout::set(aborted_delayed);
+    });
+
+    bool finished = false;
+
+    try {
+      expect_bsgs_equal(BSGS(generators, &bsgs_options, aborted_delayed));
+      finished = true;
+    } catch (timeout::AbortedError const &) {}
+
+    abort_thread.join();
+
+    if (finished)
+      break;
+  }
+}
+
 //TEST(BSGSBaseSwapTest, CanConjugateBSGS)
 //{
 //  PermGroup pg(5, {Perm(5, {{1, 2}, {3, 4}}), Perm(5, {{1, 4, 2}})});
@@ -1,5 +1,7 @@
 #include <algorithm>
 #include <memory>
+#include <random>
+#include <stdexcept>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -7,9 +9,11 @@
 #include "gmock/gmock.h"
 
 #include "bsgs.hpp"
+#include "element_table.hpp"
 #include "perm.hpp"
 #include "perm_group.hpp"
 #include "perm_set.hpp"
+#include "task_mapping.hpp"
 #include "test_utility.hpp"
 #include "util.hpp"
 
@@ -120,6 +124,94 @@ TEST(PermGroupTest, CanDetermineTransitivity)
     << "Non-transitive group correctly identified as such.";
 }
 
+TEST(PermGroupTest, CanDetermineFixedPointsDistribution)
+{
+  auto s2(PermGroup::symmetric(2));
+  auto s3(PermGroup::symmetric(3));
+  auto c3(PermGroup::cyclic(3));
+  auto c4(PermGroup::cyclic(4));
+
+  std::vector<PermGroup> groups {
+    PermGroup::wreath_product(s3, s2),
+    PermGroup::wreath_product(c3, s3),
+    PermGroup::wreath_product(s2, c4),
+    PermGroup::wreath_product(c4, c3),
+    PermGroup::wreath_product(PermGroup::wreath_product(s2, s2), s2),
+    PermGroup(8,
+      {
+        Perm(8, {{2, 3}}),
+        Perm(8, {{2, 4}, {3, 5}})
+      }),
+    PermGroup(7,
+      {
+        Perm(7, {{0, 1}, {3, 4, 5}}),
+        Perm(7, {{0, 1, 2}}),
+        Perm(7, {{3, 4}})
+      }),
+    PermGroup(6,
+      {
+        Perm(6, {{0, 1, 2}, {3, 4, 5}}),
+        Perm(6, {{0, 1}, {3, 4}})
+      }),
+    PermGroup(6,
+      {
+        Perm(6, {{0, 1, 2, 3, 4, 5}}),
+        Perm(6, {{0, 5}, {1, 4}, {2, 3}})
+      })
+  };
+
+  for (auto const &group : groups) {
+    std::vector<BSGS::order_type> expected(group.degree() + 1u, 0);
+
+    for (Perm const &perm : group) {
+      unsigned fixed = 0u;
+      for (unsigned x = 0u; x < group.degree(); ++x) {
+        if (perm[x] == x)
+          ++fixed;
+      }
+
+      ++expected[fixed];
+    }
+
+    EXPECT_EQ(expected, group.fixed_points_distribution())
+      << "Fixed points distribution of " << group << " correct.";
+  }
+
+  auto large_wreath_product(
+    PermGroup::wreath_product(PermGroup::symmetric(16),
+                              PermGroup::symmetric(4)));
+
+  auto dist(large_wreath_product.fixed_points_distribution());
+
+  ASSERT_EQ(65u, dist.size())
+    << "Fixed points distribution of large wreath product has correct size.";
+
+  BSGS::order_type order = 0;
+  for (auto const &num_elements : dist)
+    order += num_elements;
+
+  EXPECT_EQ(large_wreath_product.order(), order)
+    << "Fixed points distribution of large wreath product covers all elements.";
+
+  EXPECT_EQ(1, dist[64])
+    << "Only identity fixes all points of large wreath product.";
+
+  EXPECT_EQ(0, dist[63])
+    << "No element fixes all but one point of large wreath product.";
+
+  EXPECT_EQ(4 * 16 * 15 / 2, dist[62])
+    << "Transpositions in large wreath product counted correctly.";
+
+  PermGroup alternating(12,
+    {
+      Perm(12, {{0, 1, 2}}),
+      Perm(12, {{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}})
+    });
+
+  EXPECT_THROW(alternating.fixed_points_distribution(), std::runtime_error)
+    << "Fixed points of large group of unknown structure not enumerated.";
+}
+
 TEST(PermGroupTest, CanTestMembership)
 {
   PermGroup a4(verified_perm_group(A4));
@@ -165,6 +257,34 @@ TEST(PermGroupTest, CanTestMembership)
   }
 }
 
+TEST(PermGroupTest, CanTestMembershipBatched)
+{
+  PermGroup pg(6, {
+    Perm(6, {{0, 1, 2}}),
+    Perm(6, {{0, 3}, {1, 4}, {2, 5}}),
+    Perm(6, {{3, 4}})
+  });
+
+  auto s6(PermGroup::symmetric(6));
+
+  std::vector<Perm> candidates;
+  for (Perm const &perm : s6)
+    candidates.push_back(perm);
+
+  for (unsigned num_threads : {1u, 3u}) {
+    auto contained(pg.contains_elements(candidates, num_threads));
+
+    ASSERT_EQ(candidates.size(), contained.size())
+      << "Batched membership test returns one result per element.";
+
+    for (std::size_t i = 0u; i < candidates.size(); ++i) {
+      EXPECT_EQ(pg.contains_element(candidates[i]), contained[i])
+        << "Batched membership test agrees with single membership test for "
+        << candidates[i];
+    }
+  }
+}
+
 TEST(PermGroupTest, CanGenerateRandomElement)
 {
   PermGroup a4(verified_perm_group(A4));
@@ -273,6 +393,120 @@ TEST(PermGroupTest, CanIterateElements)
     << "Iteration produces every element exactly once (explicit iterator).";
 }
 
+TEST(PermGroupTest, CanTabulateElements)
+{
+  std::vector<PermGroup> groups {
+    PermGroup(4, {}),
+    verified_perm_group(A4),
+    PermGroup(6, {
+      Perm(6, {{0, 1, 2}}),
+      Perm(6, {{0, 3}, {1, 4}, {2, 5}}),
+      Perm(6, {{3, 4}})
+    }),
+    PermGroup::symmetric(5),
+    PermGroup::cyclic(300)
+  };
+
+  for (auto const &pg : groups) {
+    std::vector<Perm> expected_members;
+    for (Perm const &perm : pg)
+      expected_members.push_back(perm);
+
+    for (unsigned num_threads : {1u, 3u}) {
+      ElementTable table(pg, num_threads);
+
+      ASSERT_EQ(expected_members.size(), table.size())
+        << "Element table has correct size.";
+
+      std::vector<Perm> actual_members;
+      for (std::size_t i = 0u; i < table.size(); ++i)
+        actual_members.push_back(table.element(i));
+
+      EXPECT_TRUE(actual_members[0].id())
+        << "Identity is first tabulated element.";
+
+      EXPECT_TRUE(std::is_sorted(actual_members.begin(),
+                                 actual_members.end(),
+                                 [](Perm const &lhs, Perm const &rhs)
+                                 { return lhs.vect() < rhs.vect(); }))
+        << "Tabulated elements are sorted by their images.";
+
+      EXPECT_THAT(actual_members, UnorderedElementsAreArray(expected_members))
+        << "Element table contains every element exactly once.";
+
+      for (Perm const &perm : expected_members) {
+        EXPECT_TRUE(table.contains(perm))
+          << "Element table membership test accepts " << perm;
+      }
+    }
+  }
+
+  PermGroup a4(verified_perm_group(A4));
+  ElementTable table_a4(a4);
+
+  for (Perm const &perm : PermGroup::symmetric(4)) {
+    EXPECT_EQ(a4.contains_element(perm), table_a4.contains(perm))
+      << "Element table membership test correct for " << perm;
+  }
+
+  std::mt19937 re(0u);
+  for (unsigned i = 0u; i < 100u; ++i) {
+    EXPECT_TRUE(a4.contains_element(table_a4.random_element(re)))
+      << "Random element drawn from element table is inside group.";
+  }
+
+  EXPECT_THROW(ElementTable(PermGroup::symmetric(5), 1u, 100u),
+               std::invalid_argument)
+    << "Element table size limited.";
+}
+
+TEST(PermGroupTest, CanFindMinimalImagesInElementTable)
+{
+  std::vector<PermGroup> groups {
+    PermGroup(4, {}),
+    verified_perm_group(A4),
+    PermGroup::symmetric(5),
+    PermGroup::dihedral(300)
+  };
+
+  std::mt19937 re(0u);
+
+  for (auto const &pg : groups) {
+    ElementTable table(pg);
+
+    std::uniform_int_distribution<unsigned> d(0u, pg.degree() + 1u);
+
+    for (unsigned i = 0u; i < 100u; ++i) {
+      std::vector<unsigned> tasks(5u);
+      for (auto &task : tasks)
+        task = d(re);
+
+      TaskMapping mapping(tasks);
+
+      for (unsigned offset : {0u, 1u}) {
+        TaskMapping expected(mapping);
+        for (std::size_t j = 0u; j < table.size(); ++j) {
+          auto image(table.permuted(j, mapping, offset));
+          if (image.less_than(expected))
+            expected = image;
+        }
+
+        for (bool simd : {false, true}) {
+          table.set_simd(simd);
+
+          auto actual(table.min_elem(mapping,
+                                     offset,
+                                     [](TaskMapping const &){ return false; }));
+
+          EXPECT_EQ(expected, actual)
+            << "Element table yields minimal image of " << mapping
+            << " (offset " << offset << ", simd " << table.simd() << ").";
+        }
+      }
+    }
+  }
+}
+
 class PermGroupConstructionMethodTest : public testing::TestWithParam<
   std::tuple<BSGSOptions::Construction, BSGSOptions::Transversals>> {};
 
@@ -366,9 +600,11 @@ TEST_P(PermGroupConstructionMethodTest, CanGenerateCorrectGroupElements)
 INSTANTIATE_TEST_SUITE_P(ConstructionMethods, PermGroupConstructionMethodTest,
   testing::Combine(
     testing::Values(BSGSOptions::Construction::SCHREIER_SIMS,
-                    BSGSOptions::Construction::SCHREIER_SIMS_RANDOM),
+                    BSGSOptions::Construction::SCHREIER_SIMS_RANDOM,
+                    BSGSOptions::Construction::SOLVE),
     testing::Values(BSGSOptions::Transversals::EXPLICIT,
-                    BSGSOptions::Transversals::SCHREIER_TREES)));
+                    BSGSOptions::Transversals::SCHREIER_TREES,
+                    BSGSOptions::Transversals::HYBRID)));
                     // TODO: SHALLOW_SCHREIER_TREES
 
 TEST(PermGroupCombinationTest, CanConstructDirectProduct)
@@ -5,6 +5,7 @@
 #include "gmock/gmock.h"
 
 #include "explicit_transversals.hpp"
+#include "hybrid_transversals.hpp"
 #include "orbit.hpp"
 #include "perm.hpp"
 #include "perm_set.hpp"
@@ -92,3 +93,103 @@ TYPED_TEST(SchreierStructureTest, CanConstructSchreierStructures)
     }
   }
 }
+
+TEST(HybridTransversalsTest, RespectsMemoryBudget)
+{
+  unsigned n = 16;
+
+  PermSet generators {
+    Perm(n, {{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}}),
+    Perm(n, {{0, 1}})
+  };
+
+  generators.insert_inverses();
+
+  std::size_t perm_bytes = HybridTransversalsBudget::perm_bytes(n);
+
+  std::size_t budgets[] = {0u, 3u * perm_bytes, 1u << 20};
+
+  for (std::size_t budget : budgets) {
+    auto shared_budget(std::make_shared<HybridTransversalsBudget>(budget));
+
+    auto schreier_structure(
+      std::make_shared<HybridTransversals>(n, 0u, generators, shared_budget));
+
+    Orbit::generate(0u, generators, schreier_structure);
+
+    for (unsigned rep = 0u; rep < 2u; ++rep) {
+      for (unsigned origin = 0u; origin < n; ++origin) {
+        Perm transv(schreier_structure->transversal(origin));
+
+        EXPECT_EQ(origin, transv[0u])
+          << "Transversal " << transv << " correct "
+          << "(budget is " << budget << ", origin is " << origin << ").";
+
+        EXPECT_LE(shared_budget->bytes_used(), budget)
+          << "Memory budget respected "
+          << "(budget is " << budget << ", origin is " << origin << ").";
+      }
+    }
+
+    EXPECT_EQ(budget == (1u << 20), schreier_structure->is_explicit())
+      << "Frequently accessed transversals become explicit iff they fit "
+      << "(budget is " << budget << ").";
+  }
+}
+
+TEST(HybridTransversalsTest, RetriesMaterializationWithBackOff)
+{
+  unsigned n = 16;
+
+  PermSet generators {
+    Perm(n, {{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}}),
+    Perm(n, {{0, 1}})
+  };
+
+  generators.insert_inverses();
+
+  auto make_explicit = [&](std::shared_ptr<HybridTransversalsBudget> budget)
+  {
+    auto schreier_structure(
+      std::make_shared<HybridTransversals>(n, 0u, generators, budget));
+
+    Orbit::generate(0u, generators, schreier_structure);
+
+    for (unsigned origin = 0u; origin < n; ++origin)
+      schreier_structure->transversal(origin);
+
+    return schreier_structure;
+  };
+
+  auto unlimited_budget(std::make_shared<HybridTransversalsBudget>(1u << 20));
+  auto unlimited(make_explicit(unlimited_budget));
+
+  // only one level fits
+  std::size_t explicit_bytes = unlimited_budget->bytes_used();
+  auto shared_budget(std::make_shared<HybridTransversalsBudget>(
+    explicit_bytes + explicit_bytes / 2u));
+
+  auto first(make_explicit(shared_budget));
+  auto second(make_explicit(shared_budget));
+
+  ASSERT_TRUE(first->is_explicit());
+  ASSERT_FALSE(second->is_explicit());
+
+  for (unsigned rep = 0u; rep < 100u; ++rep) {
+    for (unsigned origin = 0u; origin < n; ++origin)
+      EXPECT_EQ(origin, second->transversal(origin)[0u]);
+  }
+
+  EXPECT_FALSE(second->is_explicit())
+    << "Transversals do not become explicit while budget is exhausted.";
+
+  first.reset();
+
+  for (unsigned rep = 0u; rep < 200u; ++rep) {
+    for (unsigned origin = 0u; origin < n; ++origin)
+      EXPECT_EQ(origin, second->transversal(origin)[0u]);
+  }
+
+  EXPECT_TRUE(second->is_explicit())
+    << "Transversals become explicit once budget is freed again.";
+}